@@ -1,4 +1,5 @@
 #include "Command.h"
+#include <sstream>
 
 using namespace std;
 
@@ -9,6 +10,20 @@ CmdType parseCommand(const string& cmdStr) {
     if (cmdStr == "TRAMS_IN_STOP") return CmdType::TRAMS_IN_STOP; // команда просмотра трамваев на остановке
     if (cmdStr == "STOPS_IN_TRAM") return CmdType::STOPS_IN_TRAM; // команда просмотра остановок маршрута
     if (cmdStr == "TRAMS") return CmdType::TRAMS;               // команда вывода всех маршрутов
+    if (cmdStr == "STATS") return CmdType::STATS;               // команда вывода статистики
     if (cmdStr == "QUIT") return CmdType::QUIT;                 // команда выхода из программы
     return CmdType::UNKNOWN;                                    // неизвестная команда
 }
+
+// функция для разделения строки на отдельные слова
+vector<string> splitCommand(const string& input) {
+    vector<string> tokens;  // вектор для хранения результата
+    istringstream iss(input); // строковый поток для чтения
+    string token;            // временная переменная для хранения слова
+    
+    // последовательное чтение слов из потока
+    while (iss >> token) {
+        tokens.push_back(token);  // добавление слова в вектор
+    }
+    return tokens;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 
 // Типы команд для управления трамвайными маршрутами
 enum class CmdType {
@@ -7,9 +8,13 @@ enum class CmdType {
     TRAMS_IN_STOP, // Показать маршруты через остановку
     STOPS_IN_TRAM, // Показать остановки на маршруте
     TRAMS,     // Показать все маршруты
+    STATS,          // Показать статистику выполнения команд
     QUIT,           // Выйти из программы
     UNKNOWN         // Некорректная команда
 };
 
 // Определяет тип команды по строке ввода
 CmdType parseCommand(const std::string& cmdStr);
+
+// Разбивает строку ввода на отдельные слова
+std::vector<std::string> splitCommand(const std::string& input);
@@ -0,0 +1,345 @@
+#include "CommandEngine.h"
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <csignal>
+#include <pthread.h>
+#include <sched.h>
+
+using namespace std;
+
+// размер накопленного вывода, после которого он сразу передается потоку вывода
+const size_t OUTPUT_BATCH = 4096;
+
+// сколько байт вывода может ждать потока вывода: элементы выходного буфера бывают
+// любого размера, поэтому одного ограничения на их число недостаточно
+const size_t MAX_OUTPUT_BACKLOG = 1024 * 1024;
+
+// сигнал, которым прерывается ожидание ввода потоком чтения при остановке движка
+const int READER_STOP_SIGNAL = SIGURG;
+
+static void onReaderStopSignal(int) {}
+
+// сколько раз уступить процессор, прежде чем заснуть на пустом/заполненном буфере:
+// при потоке команд из файла данные появляются почти сразу и сон не нужен,
+// а ожидающий ввода с клавиатуры поток спит до сигнала другой стороны
+const int SPIN_ATTEMPTS = 64;
+
+// добавление в буфер с ожиданием свободного места
+template <typename T>
+static void pushWait(SpscRing<T>& ring, T&& item) {
+    for (int attempt = 0; !ring.tryPush(move(item)); ++attempt) {
+        if (attempt < SPIN_ATTEMPTS) this_thread::yield();
+        else ring.waitUntil([&] { return !ring.full(); }, chrono::hours(1));
+    }
+}
+
+// извлечение из буфера с ожиданием элемента не дольше timeoutMs (-1 - без ограничения);
+// false - элемент так и не появился
+template <typename T>
+static bool popWait(SpscRing<T>& ring, T& item, int timeoutMs = -1) {
+    for (int attempt = 0; !ring.tryPop(item); ++attempt) {
+        if (attempt < SPIN_ATTEMPTS) {
+            this_thread::yield();
+            continue;
+        }
+        if (timeoutMs < 0) {
+            ring.waitUntil([&] { return !ring.empty(); }, chrono::hours(1));
+        } else if (!ring.waitUntil([&] { return !ring.empty(); }, chrono::milliseconds(timeoutMs))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// буфер потока, собирающий вывод команды в порции для потока вывода;
+// out и err пишут в общий сборщик, поэтому порядок сообщений сохраняется
+class OutputCollector {
+    SpscRing<CommandEngine::OutputItem>& ring;
+    atomic<size_t>& backlog; // байт в выходном буфере
+    string text;
+    bool toErr = false;
+    uint64_t allocations = 0; // выделения памяти самим сборщиком (рост text)
+
+public:
+    OutputCollector(SpscRing<CommandEngine::OutputItem>& ring, atomic<size_t>& backlog)
+        : ring(ring), backlog(backlog) {}
+
+    void append(const char* s, size_t n, bool err) {
+        if (err != toErr) {
+            flush();
+            toErr = err;
+        }
+        uint64_t before = allocationCount();
+        text.append(s, n);
+        allocations += allocationCount() - before;
+    }
+
+    size_t size() const { return text.size(); }
+    uint64_t ownAllocations() const { return allocations; }
+
+    // передача накопленного в выходной буфер
+    void flush() {
+        if (text.empty()) return;
+        CommandEngine::OutputItem item;
+        item.text = move(text);
+        item.toErr = toErr;
+        text.clear();
+        backlog.fetch_add(item.text.size());
+        pushWait(ring, move(item));
+
+        // вывод не успевает за выполнением - ждем, пока поток вывода разберет накопленное
+        if (backlog.load() > MAX_OUTPUT_BACKLOG) {
+            ring.waitUntil([&] { return backlog.load() <= MAX_OUTPUT_BACKLOG; }, chrono::hours(1));
+        }
+    }
+};
+
+class CollectorBuf : public streambuf {
+    OutputCollector& collector;
+    bool err;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (ch != traits_type::eof()) {
+            char c = (char)ch;
+            collector.append(&c, 1, err);
+        }
+        return ch;
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        collector.append(s, n, err);
+        return n;
+    }
+
+public:
+    CollectorBuf(OutputCollector& collector, bool err) : collector(collector), err(err) {}
+};
+
+CommandEngine::CommandEngine() {
+    commandStats.configureFromEnv();
+    on("STATS", [this](const Request&, ostream& out, ostream&) {
+        commandStats.print(out);
+    });
+}
+
+void CommandEngine::on(const string& command, Handler handler) {
+    handlers[command] = move(handler);
+}
+
+void CommandEngine::onUnknown(Handler handler) {
+    unknownHandler = move(handler);
+}
+
+void CommandEngine::onEmpty(Handler handler) {
+    emptyHandler = move(handler);
+}
+
+// разбор строки: команда - первое слово, параметры - все после следующего
+// за ним пробела или табуляции
+void CommandEngine::parseLine(string& line, bool caseInsensitive, InputItem& item) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+
+    size_t begin = line.find_first_not_of(" \t");
+    if (begin == string::npos) {
+        item.empty = line.empty();
+        return;
+    }
+    size_t spacePos = line.find_first_of(" \t", begin);
+    item.req.command = line.substr(begin, spacePos - begin);
+    if (spacePos != string::npos) item.req.params = line.substr(spacePos + 1);
+    if (caseInsensitive) {
+        transform(item.req.command.begin(), item.req.command.end(),
+                  item.req.command.begin(), ::toupper);
+    }
+}
+
+// поток чтения и разбора строк; завершается в конце ввода или по остановке движка
+void CommandEngine::readerLoop(shared_ptr<Shared> shared, bool caseInsensitive) {
+    string line;
+    while (!shared->stopping.load()) {
+        InputItem item;
+        if (!getline(cin, line)) {
+            if (shared->stopping.load()) {
+                // чтение прервано сигналом остановки - это не конец ввода
+                cin.clear();
+                clearerr(stdin);
+                break;
+            }
+            item.eof = true;
+        } else {
+            parseLine(line, caseInsensitive, item);
+        }
+
+        bool eof = item.eof;
+        for (int attempt = 0; !shared->input.tryPush(move(item)); ++attempt) {
+            if (shared->stopping.load()) break;
+            if (attempt < SPIN_ATTEMPTS) {
+                this_thread::yield();
+            } else {
+                shared->input.waitUntil([&] {
+                    return !shared->input.full() || shared->stopping.load();
+                }, chrono::hours(1));
+            }
+        }
+        if (eof) break;
+    }
+    shared->readerDone = true;
+}
+
+// поток вывода
+void CommandEngine::writerLoop(shared_ptr<Shared> shared) {
+    OutputItem item;
+    while (true) {
+        if (!shared->output.tryPop(item)) {
+            // пока ждем - отдаем пользователю уже записанное
+            cout.flush();
+            popWait(shared->output, item);
+        }
+        if (item.eof) break;
+
+        if (item.toErr) {
+            cout.flush(); // сообщение об ошибке не должно обогнать предыдущий вывод
+            cerr.write(item.text.data(), item.text.size());
+        } else {
+            cout.write(item.text.data(), item.text.size());
+        }
+        shared->outputBytes.fetch_sub(item.text.size());
+        shared->output.wake(); // сборщик мог заснуть на переполненном буфере
+    }
+    cout.flush();
+}
+
+// выполнение одной разобранной строки; false - строка пропущена
+bool CommandEngine::dispatch(const InputItem& item, ostream& out, ostream& err) {
+    if (item.req.command.empty()) {
+        // строка из одних пробелов пропускается, пустая - передается обработчику
+        if (!item.empty || !emptyHandler) return false;
+        emptyHandler(item.req, out, err);
+        return true;
+    }
+
+    auto it = handlers.find(item.req.command);
+    if (it != handlers.end()) {
+        it->second(item.req, out, err);
+    } else if (unknownHandler) {
+        unknownHandler(item.req, out, err);
+    }
+    return true;
+}
+
+// выполнение с замером времени и числа выделений памяти;
+// выделения сборщика вывода относятся к движку, а не к обработчику
+bool CommandEngine::dispatchTimed(const InputItem& item, ostream& out, ostream& err,
+                                  const OutputCollector* collector) {
+    uint64_t collectorBefore = collector ? collector->ownAllocations() : 0;
+    uint64_t allocsBefore = allocationCount();
+    auto start = chrono::steady_clock::now();
+    bool handled = dispatch(item, out, err);
+    auto elapsed = chrono::steady_clock::now() - start;
+    uint64_t allocs = allocationCount() - allocsBefore
+                    - (collector ? collector->ownAllocations() - collectorBefore : 0);
+    if (!handled) return false;
+
+    // неизвестные команды учитываем вместе, чтобы опечатки не раздували таблицу
+    string_view name = item.req.command.empty() ? "<пусто>"
+                     : handlers.count(item.req.command) ? string_view(item.req.command) : "<неизвестная>";
+    commandStats.record(name, chrono::duration_cast<chrono::nanoseconds>(elapsed).count(), allocs);
+    commandStats.maybeDump();
+    return true;
+}
+
+// число процессоров, на которых может выполняться программа
+static int availableCpus() {
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return (int)thread::hardware_concurrency();
+    return CPU_COUNT(&set);
+}
+
+void CommandEngine::run() {
+    stopped = false;
+    if (availableCpus() <= 1 && commandStats.msUntilDump() < 0) runSingle();
+    else runPipelined();
+}
+
+// однопоточный цикл: как в исходных программах, вывод идет прямо в cout/cerr
+void CommandEngine::runSingle() {
+    string line;
+    bool needPrompt = true; // после пропущенной строки приглашение не повторяем
+    while (!stopped) {
+        if (needPrompt) cout << prompt;
+
+        InputItem item;
+        if (!getline(cin, line)) break;
+        parseLine(line, caseInsensitive, item);
+
+        needPrompt = commandStats.isEnabled() ? dispatchTimed(item, cout, cerr, nullptr)
+                                              : dispatch(item, cout, cerr);
+    }
+    commandStats.dump();
+    cout.flush();
+}
+
+void CommandEngine::runPipelined() {
+    // дальше cout пишет только поток вывода, а cin читает только поток чтения
+    cout.flush();
+    cin.tie(nullptr);
+
+    // сигнал остановки должен прерывать read(), а не перезапускать его
+    struct sigaction stopAction {}, oldAction {};
+    stopAction.sa_handler = onReaderStopSignal;
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(READER_STOP_SIGNAL, &stopAction, &oldAction);
+
+    shared = make_shared<Shared>();
+    thread reader(readerLoop, shared, caseInsensitive);
+    thread writer(writerLoop, shared);
+
+    OutputCollector collector(shared->output, shared->outputBytes);
+    CollectorBuf outBuf(collector, false);
+    CollectorBuf errBuf(collector, true);
+    ostream out(&outBuf);
+    ostream err(&errBuf);
+
+    bool needPrompt = true; // после пропущенной строки приглашение не повторяем
+    while (!stopped) {
+        if (needPrompt) out << prompt;
+
+        // новых строк пока нет - дальше будем ждать, поэтому отдаем вывод сразу
+        if (shared->input.empty()) collector.flush();
+
+        // пока ввода нет, статистика все равно записывается в файл по расписанию
+        InputItem item;
+        while (!popWait(shared->input, item, commandStats.msUntilDump())) {
+            commandStats.maybeDump();
+        }
+        if (item.eof) break;
+
+        needPrompt = commandStats.isEnabled() ? dispatchTimed(item, out, err, &collector)
+                                              : dispatch(item, out, err);
+        if (collector.size() >= OUTPUT_BATCH) collector.flush();
+    }
+
+    // завершение: дописываем вывод и статистику, останавливаем потоки
+    collector.flush();
+    commandStats.dump();
+    OutputItem last;
+    last.eof = true;
+    pushWait(shared->output, move(last));
+    writer.join();
+
+    // поток чтения может ждать ввода с клавиатуры: прерываем read() сигналом,
+    // повторяя его на случай, если сигнал пришел до входа в read()
+    shared->stopping = true;
+    shared->input.wake(); // или заснуть на заполненном буфере
+    for (int attempt = 0; !shared->readerDone.load(); ++attempt) {
+        if (attempt % 10 == 0) pthread_kill(reader.native_handle(), READER_STOP_SIGNAL);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    reader.join();
+    sigaction(READER_STOP_SIGNAL, &oldAction, nullptr);
+    cin.tie(&cout);
+}
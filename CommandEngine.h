@@ -0,0 +1,90 @@
+#pragma once
+#include "SpscRing.h"
+#include "CommandStats.h"
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <iostream>
+#include <memory>
+
+// Общий цикл "чтение - разбор - выполнение - вывод" для консольных программ.
+// Работает конвейером из трех потоков, связанных кольцевыми буферами:
+//   поток чтения:  читает строки из cin и разбирает их на команду и параметры;
+//   основной поток: выполняет обработчики команд (только он меняет данные программы);
+//   поток вывода:  пишет накопленный вывод в cout/cerr.
+// Поэтому при большом входном сценарии чтение и вывод идут параллельно с выполнением.
+// Если программе доступен один процессор, конвейер только добавляет переключения
+// потоков, поэтому строки читаются и выполняются в одном потоке (кроме случая
+// периодической записи статистики в файл: ей нужно ожидание ввода с таймаутом).
+// Команда STATS встроена: выводит число вызовов и задержки каждой команды
+// (если статистика включена, см. CommandStats.h).
+
+// Разобранная строка ввода
+struct Request {
+    std::string command; // первое слово строки
+    std::string params;  // остаток строки после первого пробела или табуляции
+};
+
+class OutputCollector;
+
+// Обработчик команды: пишет результат в out, сообщения об ошибках - в err
+using Handler = std::function<void(const Request& req, std::ostream& out, std::ostream& err)>;
+
+class CommandEngine {
+public:
+    // элемент входного буфера
+    struct InputItem {
+        Request req;
+        bool empty = false; // пустая строка
+        bool eof = false;   // ввод закончился
+    };
+
+    // элемент выходного буфера
+    struct OutputItem {
+        std::string text;
+        bool toErr = false; // писать в cerr
+        bool eof = false;   // вывод закончен
+    };
+
+private:
+    // общее состояние потоков
+    struct Shared {
+        SpscRing<InputItem> input{1024};
+        SpscRing<OutputItem> output{1024};
+        std::atomic<size_t> outputBytes{0};  // объем вывода, еще не записанного потоком вывода
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> readerDone{false}; // поток чтения завершился
+    };
+
+    std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+    std::unordered_map<std::string, Handler> handlers;
+    Handler unknownHandler;
+    Handler emptyHandler;
+    std::string prompt;
+    bool caseInsensitive = false;
+    bool stopped = false;
+    CommandStats commandStats;
+
+    static void parseLine(std::string& line, bool caseInsensitive, InputItem& item);
+    static void readerLoop(std::shared_ptr<Shared> shared, bool caseInsensitive);
+    static void writerLoop(std::shared_ptr<Shared> shared);
+    bool dispatch(const InputItem& item, std::ostream& out, std::ostream& err);
+    bool dispatchTimed(const InputItem& item, std::ostream& out, std::ostream& err,
+                       const OutputCollector* collector);
+    void runPipelined(); // три потока
+    void runSingle();    // один поток, для одного процессора
+
+public:
+    CommandEngine();
+
+    void on(const std::string& command, Handler handler); // регистрация команды
+    void onUnknown(Handler handler);   // неизвестная команда
+    void onEmpty(Handler handler);     // пустая строка (по умолчанию пропускается)
+    void setPrompt(const std::string& text) { prompt = text; } // приглашение перед каждой командой
+    void setCaseInsensitive(bool value) { caseInsensitive = value; } // команды в любом регистре
+
+    CommandStats& stats() { return commandStats; }
+
+    void stop() { stopped = true; } // завершить работу после текущей команды
+    void run();                     // основной цикл; возвращается после stop() или конца ввода
+};
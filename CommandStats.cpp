@@ -0,0 +1,236 @@
+#include "CommandStats.h"
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+using namespace std;
+
+// ===== подсчет выделений памяти =====
+// счетчик свой у каждого потока, поэтому увеличивается без синхронизации
+
+static thread_local uint64_t allocations = 0;
+
+uint64_t allocationCount() {
+    return allocations;
+}
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    ++allocations;
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+
+// ===== гистограмма =====
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < (uint64_t)SUB_COUNT) return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BITS;
+    int sub = (int)((value >> shift) & (SUB_COUNT - 1));
+    return (shift + 1) * SUB_COUNT + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int index) {
+    int group = index / SUB_COUNT;
+    uint64_t sub = index % SUB_COUNT;
+    if (group == 0) return sub;
+    return (SUB_COUNT + sub) << (group - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index + 1 >= BUCKET_COUNT) return UINT64_MAX;
+    return bucketLowerBound(index + 1) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++counts[bucketIndex(value)];
+    ++total;
+    sum += value;
+    if (value > max) max = value;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * total);
+    if (rank >= total) rank = total - 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts[i];
+        if (seen > rank) return min(bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+uint64_t LatencyHistogram::countAtMost(uint64_t value) const {
+    uint64_t result = 0;
+    for (int i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= value; ++i) {
+        result += counts[i];
+    }
+    return result;
+}
+
+// ===== статистика команд =====
+
+void CommandStats::configureFromEnv() {
+    const char* flag = getenv("CMD_STATS");
+    if (flag && string(flag) != "0") enable();
+
+    const char* file = getenv("CMD_STATS_FILE");
+    if (file && *file) {
+        const char* interval = getenv("CMD_STATS_INTERVAL");
+        setDumpFile(file, interval ? atoi(interval) : 10);
+    }
+}
+
+void CommandStats::setDumpFile(const string& path, int intervalSeconds) {
+    enable(); // запись в файл без сбора статистики не имеет смысла
+    dumpFile = path;
+    dumpInterval = chrono::seconds(intervalSeconds > 0 ? intervalSeconds : 10);
+    nextDump = chrono::steady_clock::now() + dumpInterval;
+}
+
+void CommandStats::record(string_view command, uint64_t nanoseconds, uint64_t allocs) {
+    auto it = commands.find(command);
+    if (it == commands.end()) it = commands.emplace(string(command), CommandCounters()).first;
+    CommandCounters& counters = it->second;
+    ++counters.calls;
+    counters.allocations += allocs;
+    counters.latency.record(nanoseconds);
+}
+
+// выравнивание по числу символов, а не байт (setw считает байты UTF-8)
+static string padded(const string& text, size_t width, bool alignLeft) {
+    size_t chars = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) ++chars;
+    }
+    string padding(chars < width ? width - chars : 0, ' ');
+    return alignLeft ? text + padding : padding + text;
+}
+
+static string formatMicros(uint64_t nanoseconds) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", nanoseconds / 1000.0);
+    return buf;
+}
+
+void CommandStats::print(ostream& out) const {
+    if (!enabled) {
+        out << "статистика выключена (запустите программу с CMD_STATS=1)\n";
+        return;
+    }
+    if (commands.empty()) {
+        out << "команды еще не выполнялись\n";
+        return;
+    }
+
+    // задержки выводятся в микросекундах
+    out << padded("команда", 16, true) << padded("вызовов", 10, false)
+        << padded("p50,мкс", 10, false) << padded("p90,мкс", 10, false)
+        << padded("p99,мкс", 10, false) << padded("max,мкс", 10, false)
+        << padded("выделений", 12, false) << "\n";
+    for (const auto& [name, c] : commands) {
+        char allocs[32];
+        snprintf(allocs, sizeof(allocs), "%.1f", (double)c.allocations / c.calls);
+        out << padded(name, 16, true) << padded(to_string(c.calls), 10, false)
+            << padded(formatMicros(c.latency.percentile(50)), 10, false)
+            << padded(formatMicros(c.latency.percentile(90)), 10, false)
+            << padded(formatMicros(c.latency.percentile(99)), 10, false)
+            << padded(formatMicros(c.latency.maxValue()), 10, false)
+            << padded(allocs, 12, false) << "\n";
+    }
+}
+
+// экранирование значения метки по правилам формата Prometheus
+static string escapeLabel(const string& value) {
+    string result;
+    for (char c : value) {
+        if (c == '\\' || c == '"') result += '\\';
+        if (c == '\n') {
+            result += "\\n";
+            continue;
+        }
+        result += c;
+    }
+    return result;
+}
+
+void CommandStats::writePrometheus(ostream& out) const {
+    // границы корзин - верхние границы корзин LatencyHistogram на степенях двойки
+    // (2^k - 1 нс, от ~1 мкс до ~17 с): десятичная граница попала бы внутрь корзины
+    // гистограммы, и часть замеров из нее оказалась бы не в той корзине
+    const int MIN_POWER = 10, MAX_POWER = 34;
+
+    out << "# HELP command_calls_total Number of executed commands.\n";
+    out << "# TYPE command_calls_total counter\n";
+    for (const auto& [name, c] : commands) {
+        out << "command_calls_total{command=\"" << escapeLabel(name) << "\"} " << c.calls << "\n";
+    }
+
+    out << "# HELP command_allocations_total Heap allocations made by command handlers.\n";
+    out << "# TYPE command_allocations_total counter\n";
+    for (const auto& [name, c] : commands) {
+        out << "command_allocations_total{command=\"" << escapeLabel(name) << "\"} "
+            << c.allocations << "\n";
+    }
+
+    out << "# HELP command_latency_seconds Command execution time.\n";
+    out << "# TYPE command_latency_seconds histogram\n";
+    for (const auto& [name, c] : commands) {
+        string label = escapeLabel(name);
+        for (int power = MIN_POWER; power <= MAX_POWER; ++power) {
+            uint64_t bound = (1ull << power) - 1;
+            char le[32];
+            snprintf(le, sizeof(le), "%.12g", bound / 1e9);
+            out << "command_latency_seconds_bucket{command=\"" << label << "\",le=\"" << le
+                << "\"} " << c.latency.countAtMost(bound) << "\n";
+        }
+        out << "command_latency_seconds_bucket{command=\"" << label << "\",le=\"+Inf\"} "
+            << c.latency.count() << "\n";
+        out << "command_latency_seconds_sum{command=\"" << label << "\"} "
+            << c.latency.totalSum() / 1e9 << "\n";
+        out << "command_latency_seconds_count{command=\"" << label << "\"} "
+            << c.latency.count() << "\n";
+    }
+}
+
+void CommandStats::maybeDump() {
+    if (dumpFile.empty() || chrono::steady_clock::now() < nextDump) return;
+    dump();
+}
+
+int CommandStats::msUntilDump() const {
+    if (dumpFile.empty()) return -1;
+    auto left = chrono::ceil<chrono::milliseconds>(nextDump - chrono::steady_clock::now());
+    return left.count() > 0 ? (int)left.count() : 0;
+}
+
+// запись во временный файл и замена, чтобы читатель не увидел файл наполовину
+void CommandStats::dump() {
+    if (dumpFile.empty()) return;
+    nextDump = chrono::steady_clock::now() + dumpInterval;
+
+    string tmpFile = dumpFile + ".tmp";
+    {
+        ofstream out(tmpFile, ios::trunc);
+        writePrometheus(out);
+        if (!out) {
+            cerr << "ошибка: не удалось записать статистику в " << tmpFile << "\n";
+            return;
+        }
+    }
+    if (rename(tmpFile.c_str(), dumpFile.c_str()) != 0) {
+        cerr << "ошибка: не удалось заменить файл статистики " << dumpFile << "\n";
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <array>
+#include <map>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Гистограмма задержек в стиле HDR: диапазоны по степеням двойки,
+// каждый разбит на 8 равных частей (погрешность не больше 12.5%).
+// Запись - O(1), память фиксирована и не зависит от числа замеров.
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 3;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> counts{};
+    uint64_t total = 0; // число замеров
+    uint64_t sum = 0;   // сумма значений
+    uint64_t max = 0;   // наибольшее значение
+
+public:
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketLowerBound(int index);
+    static uint64_t bucketUpperBound(int index); // наибольшее значение, попадающее в корзину
+
+    void record(uint64_t value);
+    uint64_t percentile(double p) const; // верхняя граница корзины, содержащей p-й процентиль
+    // замеров не больше value; точно, если value - верхняя граница корзины,
+    // иначе корзина, внутрь которой попадает value, не учитывается
+    uint64_t countAtMost(uint64_t value) const;
+
+    uint64_t count() const { return total; }
+    uint64_t totalSum() const { return sum; }
+    uint64_t maxValue() const { return max; }
+};
+
+// Счетчики одной команды
+struct CommandCounters {
+    uint64_t calls = 0;       // сколько раз выполнена
+    uint64_t allocations = 0; // сколько выделений памяти сделали обработчики
+    LatencyHistogram latency; // время выполнения, нс
+};
+
+// Статистика выполнения команд.
+// Включается переменными окружения:
+//   CMD_STATS=1                - сбор статистики (команда STATS);
+//   CMD_STATS_FILE=<путь>      - периодическая запись в файл в текстовом формате Prometheus;
+//   CMD_STATS_INTERVAL=<сек>   - период записи (по умолчанию 10 с).
+// Пока статистика выключена, в точке вызова команды остается одна проверка флага.
+class CommandStats {
+    // ключ: название команды; less<> позволяет искать по string_view без временной строки
+    std::map<std::string, CommandCounters, std::less<>> commands;
+    bool enabled = false;
+    std::string dumpFile;
+    std::chrono::seconds dumpInterval{10};
+    std::chrono::steady_clock::time_point nextDump;
+
+public:
+    void configureFromEnv();
+    void enable() { enabled = true; }
+    bool isEnabled() const { return enabled; }
+    void setDumpFile(const std::string& path, int intervalSeconds);
+
+    // учет одного выполнения команды
+    void record(std::string_view command, uint64_t nanoseconds, uint64_t allocations);
+
+    void print(std::ostream& out) const;           // таблица для команды STATS
+    void writePrometheus(std::ostream& out) const; // текстовый формат Prometheus
+    void maybeDump();                              // запись в файл, если подошло время
+    int msUntilDump() const;                       // мс до следующей записи; -1 - файл не задан
+    void dump();                                   // немедленная запись в файл
+};
+
+// Число выделений памяти (operator new) в текущем потоке с момента его запуска
+uint64_t allocationCount();
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Кольцевой буфер "один писатель - один читатель" без блокировок.
+// push вызывается только из одного потока, pop - только из другого.
+// Емкость округляется вверх до степени двойки.
+// Поток, которому нечего делать (буфер пуст или заполнен), засыпает в waitUntil;
+// другая сторона будит его после push/pop, мьютекс берется только если кто-то спит.
+template <typename T>
+class SpscRing {
+    std::vector<T> slots;
+    size_t mask;
+
+    // индексы на разных кэш-линиях, чтобы потоки не мешали друг другу
+    alignas(64) std::atomic<size_t> head{0}; // следующая позиция для чтения
+    alignas(64) std::atomic<size_t> tail{0}; // следующая позиция для записи
+
+    // ожидание на случай пустого/заполненного буфера
+    alignas(64) std::atomic<int> sleepers{0};
+    std::mutex waitMutex;
+    std::condition_variable waitCond;
+
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // добавление элемента; false - буфер заполнен
+    bool tryPush(T&& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) return false;
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // извлечение элемента; false - буфер пуст
+    bool tryPop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[h & mask]);
+        // перемещающее присваивание может оставить в ячейке прежний буфер value
+        // (так делает std::string), и память держалась бы до следующего оборота кольца;
+        // перемещающий конструктор забирает буфер из ячейки, и он освобождается здесь
+        T released(std::move(slots[h & mask]));
+        head.store(h + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    bool full() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire) == slots.size();
+    }
+
+    // сон до выполнения условия (проверяется после каждого push/pop и wake)
+    // или до истечения таймаута; возвращает значение условия
+    template <typename Pred, typename Rep, typename Period>
+    bool waitUntil(Pred ready, std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(waitMutex);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        // парный барьер в wake: либо мы увидим новый элемент, либо нас увидят спящими
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result = waitCond.wait_for(lock, timeout, ready);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // разбудить ожидающих, чтобы они перепроверили условие
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) == 0) return;
+        std::lock_guard<std::mutex> lock(waitMutex);
+        waitCond.notify_all();
+    }
+};
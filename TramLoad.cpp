@@ -0,0 +1,310 @@
+// Нагрузочный клиент для сетевого режима TramProgram.
+// Открывает много соединений, в каждом держит несколько запросов "в полете"
+// и измеряет пропускную способность и задержки ответов.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// параметры нагрузки
+struct Options {
+    int port = -1;          // TCP-порт на 127.0.0.1
+    string unixPath;        // или путь Unix-сокета
+    int clients = 100;      // число одновременных соединений
+    int requests = 1000;    // запросов на одно соединение
+    int pipeline = 8;       // запросов без ожидания ответа
+    int trams = 50;         // сколько маршрутов создать перед замером
+    int stops = 200;        // размер пула остановок
+};
+
+// состояние одного клиента
+struct Client {
+    int fd = -1;
+    int sent = 0;                 // отправлено запросов
+    int received = 0;             // получено ответов
+    string out;                   // запросы, ожидающие отправки
+    size_t outSent = 0;
+    bool atLineStart = true;      // разбор ответов: находимся в начале строки
+    deque<Clock::time_point> inflight; // время отправки запросов без ответа
+    unsigned seed = 0;            // генератор запросов этого клиента
+};
+
+void printUsage(const char* prog) {
+    cout << "использование: " << prog << " (--port <порт> | --unix <путь>)"
+         << " [--clients N] [--requests N] [--pipeline N] [--trams N]" << endl;
+}
+
+// разбор номера порта: только число от 1 до 65535, иначе -1
+int parsePort(const string& text) {
+    char* end;
+    errno = 0;
+    long value = strtol(text.c_str(), &end, 10);
+    if (errno != 0 || end == text.c_str() || *end != '\0' || value < 1 || value > 65535) return -1;
+    return (int)value;
+}
+
+// подъем мягкого лимита открытых файлов до жесткого; возвращает итоговый лимит
+rlim_t raiseFdLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return RLIM_INFINITY;
+    if (limit.rlim_cur != limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &limit) != 0) getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return limit.rlim_cur;
+}
+
+int connectTo(const Options& opt) {
+    int fd;
+    if (opt.unixPath.empty()) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(opt.port);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        if (fd == -1 || connect(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+            if (fd != -1) close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, opt.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd == -1 || connect(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+            if (fd != -1) close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+// детерминированная генерация запроса: в основном точечные запросы, иногда полный список
+string makeRequest(unsigned& seed, const Options& opt) {
+    seed = seed * 1103515245u + 12345u;
+    unsigned r = (seed >> 8) % 100;
+    if (r < 45) return "TRAMS_IN_STOP s" + to_string((seed >> 4) % opt.stops) + "\n";
+    if (r < 90) return "STOPS_IN_TRAM " + to_string((seed >> 4) % opt.trams + 1) + "\n";
+    return "TRAMS\n";
+}
+
+// заполнение сервера маршрутами по одному блокирующему соединению
+bool createTrams(const Options& opt) {
+    int fd = connectTo(opt);
+    if (fd == -1) {
+        cerr << "ошибка: не удалось подключиться: " << strerror(errno) << endl;
+        return false;
+    }
+
+    string script;
+    unsigned seed = 1;
+    for (int t = 1; t <= opt.trams; ++t) {
+        script += "CREATE_TRAM " + to_string(t);
+        for (int s = 0; s < 10; ++s) {
+            seed = seed * 1103515245u + 12345u;
+            script += " s" + to_string((seed >> 8) % opt.stops);
+        }
+        script += "\n";
+    }
+    script += "QUIT\n";
+
+    for (size_t pos = 0; pos < script.size();) {
+        ssize_t n = send(fd, script.data() + pos, script.size() - pos, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        pos += n;
+    }
+    // дочитываем ответы до закрытия соединения сервером
+    char buf[4096];
+    while (recv(fd, buf, sizeof(buf), 0) > 0) {}
+    close(fd);
+    return true;
+}
+
+// постановка запросов в очередь, пока не заполнен конвейер
+void refill(Client& c, const Options& opt) {
+    auto now = Clock::now();
+    while (c.sent < opt.requests && (int)c.inflight.size() < opt.pipeline) {
+        c.out += makeRequest(c.seed, opt);
+        c.inflight.push_back(now);
+        ++c.sent;
+    }
+}
+
+// отправка накопленного; false - соединение потеряно
+bool flush(Client& c) {
+    while (c.outSent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.outSent, c.out.size() - c.outSent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.outSent += n;
+        } else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        } else if (!(n == -1 && errno == EINTR)) {
+            return false;
+        }
+    }
+    c.out.clear();
+    c.outSent = 0;
+    return true;
+}
+
+double percentile(const vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = min(sorted.size() - 1, (size_t)(p / 100.0 * sorted.size()));
+    return sorted[idx] / 1000.0; // микросекунды
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string key = argv[i];
+        string value = argv[i + 1];
+        if (key == "--port") opt.port = parsePort(value);
+        else if (key == "--unix") opt.unixPath = value;
+        else if (key == "--clients") opt.clients = atoi(value.c_str());
+        else if (key == "--requests") opt.requests = atoi(value.c_str());
+        else if (key == "--pipeline") opt.pipeline = atoi(value.c_str());
+        else if (key == "--trams") opt.trams = atoi(value.c_str());
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if ((opt.port <= 0 && opt.unixPath.empty()) || argc % 2 == 0
+        || opt.clients <= 0 || opt.requests <= 0 || opt.pipeline <= 0 || opt.trams <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // каждому клиенту нужен дескриптор, плюс несколько служебных
+    rlim_t fdLimit = raiseFdLimit();
+    if (fdLimit != RLIM_INFINITY && (rlim_t)opt.clients + 16 > fdLimit) {
+        cerr << "ошибка: лимит открытых файлов " << fdLimit << " меньше, чем нужно для "
+             << opt.clients << " клиентов (ulimit -n)" << endl;
+        return 1;
+    }
+
+    if (!createTrams(opt)) return 1;
+
+    int epollFd = epoll_create1(0);
+    vector<Client> clients(opt.clients);
+    for (int i = 0; i < opt.clients; ++i) {
+        Client& c = clients[i];
+        c.fd = connectTo(opt);
+        if (c.fd == -1) {
+            cerr << "ошибка: подключение " << i << ": " << strerror(errno) << endl;
+            return 1;
+        }
+        fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+        c.seed = i + 1;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    vector<uint64_t> latencies;
+    latencies.reserve((size_t)opt.clients * opt.requests);
+    int active = opt.clients;
+
+    auto start = Clock::now();
+    for (Client& c : clients) refill(c, opt);
+
+    vector<epoll_event> events(256);
+    char buf[16 * 1024];
+    while (active > 0) {
+        int n = epoll_wait(epollFd, events.data(), events.size(), 10000);
+        if (n == 0) {
+            cerr << "ошибка: сервер не отвечает 10 секунд" << endl;
+            return 1;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int e = 0; e < n; ++e) {
+            Client& c = clients[events[e].data.u32];
+            if (c.fd == -1) continue;
+
+            if (events[e].events & EPOLLIN) {
+                ssize_t got;
+                while ((got = recv(c.fd, buf, sizeof(buf), 0)) > 0) {
+                    auto now = Clock::now();
+                    // пустая строка отмечает конец очередного ответа
+                    for (ssize_t k = 0; k < got; ++k) {
+                        if (buf[k] != '\n') {
+                            c.atLineStart = false;
+                            continue;
+                        }
+                        if (c.atLineStart && !c.inflight.empty()) {
+                            latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(
+                                now - c.inflight.front()).count());
+                            c.inflight.pop_front();
+                            ++c.received;
+                        }
+                        c.atLineStart = true;
+                    }
+                }
+                if (got == 0 && c.received < opt.requests) {
+                    cerr << "ошибка: сервер закрыл соединение" << endl;
+                    return 1;
+                }
+                refill(c, opt);
+            }
+
+            if (!flush(c)) {
+                cerr << "ошибка: отправка: " << strerror(errno) << endl;
+                return 1;
+            }
+
+            if (c.received == opt.requests) {
+                close(c.fd);
+                c.fd = -1;
+                --active;
+                continue;
+            }
+
+            // следим за записью только пока есть неотправленные данные
+            epoll_event ev{};
+            ev.events = EPOLLIN | (c.out.empty() ? 0u : (uint32_t)EPOLLOUT);
+            ev.data.u32 = events[e].data.u32;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+        }
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    close(epollFd);
+
+    sort(latencies.begin(), latencies.end());
+    cout << fixed << setprecision(1);
+    cout << "соединений: " << opt.clients << ", запросов: " << latencies.size()
+         << ", конвейер: " << opt.pipeline << endl;
+    cout << "время: " << setprecision(3) << seconds << " с" << endl;
+    cout << setprecision(0) << "пропускная способность: " << latencies.size() / seconds
+         << " запросов/с" << endl;
+    cout << setprecision(1) << "задержка, мкс: p50=" << percentile(latencies, 50)
+         << " p90=" << percentile(latencies, 90)
+         << " p99=" << percentile(latencies, 99)
+         << " p99.9=" << percentile(latencies, 99.9)
+         << " max=" << (latencies.empty() ? 0 : latencies.back() / 1000.0) << endl;
+    return 0;
+}
@@ -1,27 +1,53 @@
 #include <iostream>
-#include <sstream>
+#include <cstdlib>
+#include <cerrno>
 #include "TramSystem.h"
+#include "TramServer.h"
 #include "Command.h"
-#include <vector>
-#include <map>
+#include "CommandEngine.h"
 using namespace std;
 
-// функция для разделения строки на отдельные слова
-vector<string> splitCommand(const string& input) {
-    vector<string> tokens;  // вектор для хранения результата
-    istringstream iss(input); // строковый поток для чтения
-    string token;            // временная переменная для хранения слова
-    
-    // последовательное чтение слов из потока
-    while (iss >> token) {
-        tokens.push_back(token);  // добавление слова в вектор
-    }
-    return tokens;
+// вывод справки по запуску программы
+void printUsage(const char* prog) {
+    cout << "использование:" << endl
+         << "  " << prog << "                    - интерактивный режим" << endl
+         << "  " << prog << " --listen <порт>    - сервер TCP" << endl
+         << "  " << prog << " --unix <путь>      - сервер на Unix-сокете" << endl;
+}
+
+// разбор номера порта: только число от 1 до 65535
+bool parsePort(const char* text, int& port) {
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || value < 1 || value > 65535) return false;
+    port = (int)value;
+    return true;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     TramSystem system;  // создание объекта системы трамваев
-    string input;       // переменная для хранения ввода пользователя
+
+    // сетевой режим: те же команды, но по сокету
+    if (argc > 1) {
+        string mode = argv[1];
+        if (argc != 3 || (mode != "--listen" && mode != "--unix")) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        int port = 0;
+        if (mode == "--listen" && !parsePort(argv[2], port)) {
+            cerr << "ошибка: неверный номер порта " << argv[2] << " (нужно число от 1 до 65535)" << endl;
+            return 1;
+        }
+
+        TramServer server(system);
+        bool ok = mode == "--listen" ? server.listenTcp(port) : server.listenUnix(argv[2]);
+        if (!ok) return 1;
+        server.run();
+        return 0;
+    }
 
     // вывод приветствия и списка команд
     cout << "=== система учета трамвайных маршрутов ===" << endl;
@@ -30,43 +56,33 @@ int main() {
          << "  TRAMS_IN_STOP <остановка> - трамваи, проходящие через эту остановку" << endl
          << "  STOPS_IN_TRAM <номер> - остановки трамвая" << endl
          << "  TRAMS - список всех трамваев" << endl
+         << "  STATS - статистика выполнения команд" << endl
          << "  QUIT - выход" << endl;
 
-    // основной цикл программы
-    while (true) {
-        cout << "\n>>> ";
-        getline(cin, input);  // чтение ввода пользователя
-        if (input.empty()) continue; // пропуск пустых строк
-
-        // разбиение ввода на аргументы
-        auto args = splitCommand(input);
-        if (args.empty()) continue; // пропуск, если нет аргументов
-
-        // определение типа команды
-        CmdType cmd = parseCommand(args[0]);
-        // подготовка аргументов команды (без первого слова)
-        vector<string> cmdArgs(args.begin() + 1, args.end());
+    // обработчики команд; каждый получает аргументы без первого слова
+    CommandEngine engine;
+    engine.setPrompt("\n>>> ");
+    engine.on("CREATE_TRAM", [&](const Request& req, ostream& out, ostream&) {
+        system.createTram(splitCommand(req.params), out);  // создание маршрута
+    });
+    engine.on("TRAMS_IN_STOP", [&](const Request& req, ostream& out, ostream&) {
+        system.showTramsAtStop(splitCommand(req.params), out);  // показ трамваев на остановке
+    });
+    engine.on("STOPS_IN_TRAM", [&](const Request& req, ostream& out, ostream&) {
+        system.showStopsForTram(splitCommand(req.params), out);  // показ остановок маршрута
+    });
+    engine.on("TRAMS", [&](const Request&, ostream& out, ostream&) {
+        system.displayAllTrams(out);  // показ всех маршрутов
+    });
+    engine.on("QUIT", [&](const Request&, ostream& out, ostream&) {
+        out << "выход из системы" << endl;
+        engine.stop();  // завершение программы
+    });
+    engine.onUnknown([](const Request&, ostream& out, ostream&) {
+        out << "неизвестная команда" << endl;
+    });
 
-        // обработка команды
-        switch (cmd) {
-            case CmdType::CREATE_TRAM:
-                system.createTram(cmdArgs);  // создание маршрута
-                break;
-            case CmdType::TRAMS_IN_STOP:
-                system.showTramsAtStop(cmdArgs);  // показ трамваев на остановке
-                break;
-            case CmdType::STOPS_IN_TRAM:
-                system.showStopsForTram(cmdArgs);  // показ остановок маршрута
-                break;
-            case CmdType::TRAMS:
-                system.displayAllTrams();  // показ всех маршрутов
-                break;
-            case CmdType::QUIT:
-                cout << "выход из системы" << endl;
-                return 0;  // завершение программы
-            case CmdType::UNKNOWN:
-                cout << "неизвестная команда" << endl;
-                break;
-        }
-    }
+    // основной цикл программы
+    engine.run();
+    return 0;
 }
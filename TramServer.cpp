@@ -0,0 +1,472 @@
+#include "TramServer.h"
+#include "Command.h"
+#include <iostream>
+#include <streambuf>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+using namespace std;
+
+// ограничения на одного клиента
+const size_t MAX_LINE_LENGTH = 64 * 1024;   // длиннее - клиент отключается
+const size_t MAX_PENDING_OUTPUT = 1 << 20;  // больше - перестаем читать запросы
+const size_t READ_CHUNK = 16 * 1024;        // размер одного чтения из сокета
+const size_t MAX_PENDING_INPUT = 4 * MAX_LINE_LENGTH; // больше - читаем после разбора
+const size_t OUTPUT_COMPACT = 64 * 1024;    // столько отправленных байт удаляем из начала out
+const int MAX_EVENTS = 256;                 // событий за один вызов epoll_wait
+
+// буфер потока, дописывающий вывод в конец строки;
+// позволяет методам TramSystem писать прямо в выходной буфер соединения
+class AppendBuf : public streambuf {
+    string* target = nullptr;
+    uint64_t allocations = 0; // выделения памяти при росте буфера ответа
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (ch != traits_type::eof()) {
+            uint64_t before = allocationCount();
+            target->push_back((char)ch);
+            allocations += allocationCount() - before;
+        }
+        return ch;
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        uint64_t before = allocationCount();
+        target->append(s, n);
+        allocations += allocationCount() - before;
+        return n;
+    }
+
+public:
+    void setTarget(string* str) { target = str; }
+    uint64_t ownAllocations() const { return allocations; }
+};
+
+// перевод дескриптора в неблокирующий режим
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+// мягкий лимит открытых файлов обычно 1024 - поднимаем до жесткого,
+// чтобы обслуживать тысячи одновременных клиентов
+static void raiseFdLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == limit.rlim_max) return;
+    limit.rlim_cur = limit.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        cerr << "предупреждение: не удалось поднять лимит открытых файлов: " << strerror(errno) << endl;
+    }
+}
+
+TramServer::TramServer(TramSystem& system) : system(system) {
+    raiseFdLimit();
+    stats.configureFromEnv();
+    spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+TramServer::~TramServer() {
+    stats.dump();
+    for (const auto& [fd, conn] : connections) close(fd);
+    if (listenFd != -1) close(listenFd);
+    if (epollFd != -1) close(epollFd);
+    if (spareFd != -1) close(spareFd);
+    if (signalFd != -1) close(signalFd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+}
+
+// общая часть подготовки слушающего сокета
+bool TramServer::setupListener(int fd) {
+    if (listen(fd, SOMAXCONN) == -1 || !setNonBlocking(fd)) {
+        cerr << "ошибка: listen: " << strerror(errno) << endl;
+        close(fd);
+        return false;
+    }
+
+    epollFd = epoll_create1(0);
+    if (epollFd == -1) {
+        cerr << "ошибка: epoll_create1: " << strerror(errno) << endl;
+        close(fd);
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    listenFd = fd;
+    return true;
+}
+
+bool TramServer::listenTcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) {
+        cerr << "ошибка: socket: " << strerror(errno) << endl;
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+        cerr << "ошибка: не удалось занять порт " << port << ": " << strerror(errno) << endl;
+        close(fd);
+        return false;
+    }
+
+    if (!setupListener(fd)) return false;
+    cout << "сервер слушает TCP-порт " << port << endl;
+    return true;
+}
+
+bool TramServer::listenUnix(const string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        cerr << "ошибка: слишком длинный путь сокета" << endl;
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        cerr << "ошибка: socket: " << strerror(errno) << endl;
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str()); // удаляем сокет, оставшийся от прошлого запуска
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+        cerr << "ошибка: не удалось создать сокет " << path << ": " << strerror(errno) << endl;
+        close(fd);
+        return false;
+    }
+
+    if (!setupListener(fd)) return false;
+    unixPath = path;
+    cout << "сервер слушает сокет " << path << endl;
+    return true;
+}
+
+// прием всех ожидающих подключений
+void TramServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                if (rejectClient()) continue;
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                cerr << "ошибка: accept: " << strerror(errno) << endl;
+            }
+            return;
+        }
+        fdExhausted = false;
+
+        // ответы короткие - отключаем задержку Нейгла (для Unix-сокета вызов просто не сработает)
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            close(fd);
+            continue;
+        }
+        connections[fd];
+    }
+}
+
+// закончились дескрипторы: освобождаем запасной, принимаем и сразу закрываем
+// подключение, иначе слушающий сокет остается готовым к чтению и цикл крутится впустую;
+// возвращает true, если подключение было отклонено и очередь стоит проверить еще раз
+bool TramServer::rejectClient() {
+    if (!fdExhausted) {
+        cerr << "ошибка: закончились дескрипторы, новые подключения отклоняются" << endl;
+        fdExhausted = true;
+    }
+
+    // accept возвращает EMFILE и при пустой очереди, поэтому ждем EAGAIN от этого вызова
+    bool rejected = false;
+    if (spareFd != -1) {
+        close(spareFd);
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd != -1) {
+            close(fd);
+            rejected = true;
+        }
+        spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+    if (spareFd == -1) {
+        // запасной дескриптор вернуть не удалось - не слушаем, пока не закроется соединение
+        epoll_event ev{};
+        ev.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, listenFd, &ev);
+        listenPaused = true;
+        return false;
+    }
+    return rejected;
+}
+
+// выполнение одной строки запроса; ответ дописывается в conn.out
+void TramServer::executeLine(const string& line, Connection& conn) {
+    auto args = splitCommand(line);
+    if (args.empty()) return; // пустые строки игнорируются, как и в консоли
+
+    static AppendBuf buf;
+    static ostream out(&buf);
+    buf.setTarget(&conn.out);
+
+    CmdType cmd = parseCommand(args[0]);
+    vector<string> cmdArgs(args.begin() + 1, args.end());
+
+    if (stats.isEnabled()) {
+        // рост буфера ответа - расход сервера, а не команды
+        uint64_t allocsBefore = allocationCount() - buf.ownAllocations();
+        auto start = chrono::steady_clock::now();
+        executeCommand(cmd, cmdArgs, conn, out);
+        auto elapsed = chrono::steady_clock::now() - start;
+        uint64_t allocs = allocationCount() - buf.ownAllocations() - allocsBefore;
+        stats.record(cmd == CmdType::UNKNOWN ? string_view("<неизвестная>") : string_view(args[0]),
+                     chrono::duration_cast<chrono::nanoseconds>(elapsed).count(), allocs);
+    } else {
+        executeCommand(cmd, cmdArgs, conn, out);
+    }
+    conn.out += '\n'; // пустая строка - конец ответа
+}
+
+void TramServer::executeCommand(CmdType cmd, const vector<string>& args, Connection& conn, ostream& out) {
+    switch (cmd) {
+        case CmdType::CREATE_TRAM:
+            system.createTram(args, out);
+            break;
+        case CmdType::TRAMS_IN_STOP:
+            system.showTramsAtStop(args, out);
+            break;
+        case CmdType::STOPS_IN_TRAM:
+            system.showStopsForTram(args, out);
+            break;
+        case CmdType::TRAMS:
+            system.displayAllTrams(out);
+            break;
+        case CmdType::STATS:
+            stats.print(out);
+            break;
+        case CmdType::QUIT:
+            out << "выход из системы" << '\n';
+            conn.closing = true;
+            break;
+        case CmdType::UNKNOWN:
+            out << "неизвестная команда" << '\n';
+            break;
+    }
+}
+
+// чтение всех доступных данных из сокета
+void TramServer::handleRead(int fd, Connection& conn) {
+    char chunk[READ_CHUNK];
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            conn.in.append(chunk, n);
+            // остальное дочитаем в следующий раз, когда принятое будет разобрано
+            if (n < (ssize_t)sizeof(chunk) || conn.in.size() >= MAX_PENDING_INPUT) break;
+            continue;
+        }
+        if (n == 0) {
+            // клиент закончил передачу - ответим на то, что успели принять, и закроем
+            conn.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeConnection(fd);
+        return;
+    }
+    processInput(fd, conn);
+}
+
+// выполнение всех полностью принятых строк (запросов может быть несколько подряд)
+void TramServer::processInput(int fd, Connection& conn) {
+    while (true) {
+        size_t start = 0;
+        while (!conn.closing) {
+            // слишком много неотправленных ответов - ждем, пока клиент их заберет
+            if (conn.out.size() - conn.outSent > MAX_PENDING_OUTPUT) break;
+
+            size_t end = conn.in.find('\n', start);
+            if (end == string::npos) break;
+
+            string line = conn.in.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            start = end + 1;
+            executeLine(line, conn);
+        }
+        conn.in.erase(0, start);
+
+        if (conn.closing) {
+            conn.in.clear(); // после QUIT остальные запросы не выполняем
+        } else if (conn.peerClosed && conn.in.find('\n') == string::npos) {
+            conn.closing = true; // больше запросов не будет
+        } else if (conn.in.size() > MAX_LINE_LENGTH && conn.in.find('\n') == string::npos) {
+            cerr << "клиент отключен: слишком длинная строка" << endl;
+            closeConnection(fd);
+            return;
+        }
+
+        if (!handleWrite(fd, conn)) return;
+        // ответы ушли сразу, а отложенные строки остались - новых событий для них не будет
+        if (conn.closing || !conn.out.empty() || conn.in.find('\n') == string::npos) break;
+    }
+    updateEvents(fd, conn);
+}
+
+// отправка накопленных ответов; возвращает false, если соединение закрыто
+bool TramServer::handleWrite(int fd, Connection& conn) {
+    while (conn.outSent < conn.out.size()) {
+        ssize_t n = send(fd, conn.out.data() + conn.outSent,
+                         conn.out.size() - conn.outSent, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.outSent += n;
+            continue;
+        }
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // клиент читает медленно - отправленное начало буфера больше не нужно
+            if (conn.outSent >= OUTPUT_COMPACT) {
+                conn.out.erase(0, conn.outSent);
+                conn.outSent = 0;
+            }
+            return true;
+        }
+        closeConnection(fd);
+        return false;
+    }
+
+    // все отправлено - буфер можно переиспользовать
+    conn.out.clear();
+    conn.outSent = 0;
+    if (conn.closing) {
+        closeConnection(fd);
+        return false;
+    }
+    return true;
+}
+
+// подписка на чтение/запись в зависимости от состояния буферов
+void TramServer::updateEvents(int fd, Connection& conn) {
+    bool wantWrite = conn.outSent < conn.out.size();
+    bool wantRead = !conn.peerClosed && !conn.closing
+                    && conn.out.size() - conn.outSent <= MAX_PENDING_OUTPUT;
+    if (wantWrite == conn.writing && wantRead == conn.reading) return;
+
+    epoll_event ev{};
+    ev.events = (wantRead ? (uint32_t)EPOLLIN : 0u) | (wantWrite ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+    conn.reading = wantRead;
+    conn.writing = wantWrite;
+}
+
+void TramServer::closeConnection(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+
+    // освободился дескриптор - снова принимаем подключения
+    if (spareFd == -1) spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (listenPaused && spareFd != -1) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, listenFd, &ev);
+        listenPaused = false;
+    }
+}
+
+// SIGINT/SIGTERM принимаются через signalfd: цикл завершается штатно,
+// а деструктор удаляет Unix-сокет и записывает итоговую статистику
+bool TramServer::setupSignals() {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    if (sigprocmask(SIG_BLOCK, &mask, nullptr) == -1) return false;
+
+    signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalFd == -1) return false;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = signalFd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &ev) != -1;
+}
+
+void TramServer::run() {
+    if (!setupSignals()) {
+        cerr << "ошибка: signalfd: " << strerror(errno) << endl;
+        return;
+    }
+
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        // без запросов ждем не дольше, чем до очередной записи статистики в файл
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, stats.msUntilDump());
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            cerr << "ошибка: epoll_wait: " << strerror(errno) << endl;
+            return;
+        }
+        stats.maybeDump();
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            if (fd == signalFd) {
+                cout << "сервер остановлен по сигналу" << endl;
+                return;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue; // уже закрыто в этой же итерации
+            Connection& conn = it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                if (!handleWrite(fd, conn)) continue;
+                // выполняем строки, отложенные из-за переполнения буфера ответов
+                if (conn.in.find('\n') != string::npos) {
+                    processInput(fd, conn);
+                    continue;
+                }
+                updateEvents(fd, conn);
+            }
+            if (events[i].events & EPOLLIN && conn.reading) {
+                handleRead(fd, conn);
+            }
+        }
+    }
+}
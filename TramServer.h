@@ -0,0 +1,56 @@
+#pragma once
+#include "TramSystem.h"
+#include "CommandStats.h"
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// Сетевой режим TramProgram: однопоточный сервер на epoll.
+// Протокол - те же строки, что и в консоли (CREATE_TRAM, TRAMS_IN_STOP,
+// STOPS_IN_TRAM, TRAMS, QUIT). Клиент может отправлять запросы подряд,
+// не дожидаясь ответов; ответы приходят в том же порядке, каждый
+// завершается пустой строкой. QUIT закрывает соединение.
+class TramServer {
+    // Состояние одного клиента
+    struct Connection {
+        string in;          // принятые, но еще не разобранные байты
+        string out;         // ответы, ожидающие отправки
+        size_t outSent = 0; // сколько байт из out уже отправлено
+        bool peerClosed = false; // клиент закончил передачу запросов
+        bool closing = false;    // закрыть после отправки ответов (QUIT или конец ввода)
+        bool reading = true;     // подписаны ли на чтение (выкл. при переполнении out)
+        bool writing = false;    // подписаны ли на запись
+    };
+
+    TramSystem& system;
+    int listenFd = -1;
+    int epollFd = -1;
+    int spareFd = -1;          // запасной дескриптор на случай их исчерпания (EMFILE)
+    bool listenPaused = false; // прием подключений приостановлен до закрытия соединения
+    bool fdExhausted = false;  // сообщение об исчерпании дескрипторов уже выведено
+    int signalFd = -1;         // SIGINT/SIGTERM для штатной остановки
+    string unixPath;                           // путь Unix-сокета (удаляется при выходе)
+    unordered_map<int, Connection> connections; // ключ: дескриптор сокета
+    CommandStats stats;                        // статистика запросов (команда STATS)
+
+    bool setupListener(int fd);
+    bool setupSignals();
+    void acceptClients();
+    bool rejectClient();
+    void handleRead(int fd, Connection& conn);
+    void processInput(int fd, Connection& conn);
+    bool handleWrite(int fd, Connection& conn);
+    void executeLine(const string& line, Connection& conn);
+    void executeCommand(CmdType cmd, const vector<string>& args, Connection& conn, ostream& out);
+    void updateEvents(int fd, Connection& conn);
+    void closeConnection(int fd);
+
+public:
+    explicit TramServer(TramSystem& system);
+    ~TramServer();
+
+    bool listenTcp(int port);           // прослушивание TCP-порта на всех интерфейсах
+    bool listenUnix(const string& path); // прослушивание Unix-сокета
+    void run();                         // основной цикл обработки событий (до SIGINT/SIGTERM)
+};
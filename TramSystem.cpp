@@ -6,10 +6,10 @@
 using namespace std;
 
 // метод для создания нового трамвайного маршрута
-void TramSystem::createTram(const vector<string>& args) {
+void TramSystem::createTram(const vector<string>& args, ostream& out) {
     // проверка наличия минимально необходимых аргументов
     if (args.size() < 2) {
-        cout << "ошибка: требуется номер трамвая и хотя бы одна остановка" << endl;
+        out << "ошибка: требуется номер трамвая и хотя бы одна остановка" << endl;
         return;
     }
 
@@ -18,7 +18,7 @@ void TramSystem::createTram(const vector<string>& args) {
 
     // проверка что номер трамвая - число (начиная с 1)
     if (tramNum.empty() || !all_of(tramNum.begin(), tramNum.end(), ::isdigit)) {
-        cout << "ошибка: номер трамвая должен быть числом (начиная с 1)" << endl;
+        out << "ошибка: номер трамвая должен быть числом (начиная с 1)" << endl;
         return;
     }
 
@@ -34,14 +34,14 @@ void TramSystem::createTram(const vector<string>& args) {
         }
     }
 
-    cout << "трамвай " << tramNum << " создан. остановок: " << stops.size() << endl;
+    out << "трамвай " << tramNum << " создан. остановок: " << stops.size() << endl;
 }
 
 // метод для показа трамваев на конкретной остановке
-void TramSystem::showTramsAtStop(const vector<string>& args) {
+void TramSystem::showTramsAtStop(const vector<string>& args, ostream& out) {
     // проверка наличия аргумента (названия остановки)
     if (args.empty()) {
-        cout << "ошибка: укажите название остановки" << endl;
+        out << "ошибка: укажите название остановки" << endl;
         return;
     }
 
@@ -50,23 +50,23 @@ void TramSystem::showTramsAtStop(const vector<string>& args) {
 
     // проверка существования остановки и наличия трамваев
     if (it == stopInfo.end() || it->second.empty()) {
-        cout << "через остановку " << stopName << " не проходит ни один трамвай" << endl;
+        out << "через остановку " << stopName << " не проходит ни один трамвай" << endl;
         return;
     }
 
     // вывод всех трамваев, проходящих через эту остановку
-    cout << "трамваи через " << stopName << ": ";
+    out << "трамваи через " << stopName << ": ";
     for (const auto& tram : it->second) {
-        cout << tram << " ";  // вывод номеров трамваев
+        out << tram << " ";  // вывод номеров трамваев
     }
-    cout << endl;
+    out << endl;
 }
 
 // метод для показа остановок конкретного трамвая
-void TramSystem::showStopsForTram(const vector<string>& args) {
+void TramSystem::showStopsForTram(const vector<string>& args, ostream& out) {
     // проверка наличия аргумента (номера трамвая)
     if (args.empty()) {
-        cout << "ошибка: укажите номер трамвая" << endl;
+        out << "ошибка: укажите номер трамвая" << endl;
         return;
     }
 
@@ -75,45 +75,45 @@ void TramSystem::showStopsForTram(const vector<string>& args) {
 
     // проверка существования маршрута
     if (it == tramRoutes.end()) {
-        cout << "трамвай " << tramNum << " не найден" << endl;
+        out << "трамвай " << tramNum << " не найден" << endl;
         return;
     }
 
     // вывод информации по маршруту
-    cout << "маршрут трамвая " << tramNum << ":" << endl;
+    out << "маршрут трамвая " << tramNum << ":" << endl;
     for (const auto& stop : it->second) {
-        cout << " - " << stop << " (пересадки: ";
+        out << " - " << stop << " (пересадки: ";
         
         // поиск трамваев для пересадки (исключая текущий)
         size_t transfers = 0;
         for (const auto& otherTram : stopInfo.at(stop)) {
             if (otherTram != tramNum) {
-                cout << otherTram << " ";
+                out << otherTram << " ";
                 transfers++;
             }
         }
         
         // если пересадок нет
-        if (transfers == 0) cout << "нет";
-        cout << ")" << endl;
+        if (transfers == 0) out << "нет";
+        out << ")" << endl;
     }
 }
 
 // метод для показа всех трамвайных маршрутов
-void TramSystem::displayAllTrams() {
+void TramSystem::displayAllTrams(ostream& out) {
     // проверка наличия маршрутов в системе
     if (tramRoutes.empty()) {
-        cout << "в системе нет трамваев" << endl;
+        out << "в системе нет трамваев" << endl;
         return;
     }
 
     // вывод всех маршрутов с их остановками
-    cout << "список всех трамваев:" << endl;
+    out << "список всех трамваев:" << endl;
     for (const auto& [num, stops] : tramRoutes) {
-        cout << "трамвай №" << num << " (" << stops.size() << " остановок): ";
+        out << "трамвай №" << num << " (" << stops.size() << " остановок): ";
         for (const auto& stop : stops) {
-            cout << stop << " ";  // вывод всех остановок маршрута
+            out << stop << " ";  // вывод всех остановок маршрута
         }
-        cout << endl;
+        out << endl;
     }
 }
@@ -3,6 +3,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <iostream>
 
 using namespace std;
 class TramSystem {
@@ -11,9 +12,10 @@ class TramSystem {
     map<string, vector<string>> stopInfo;    // ключ: название остановки, значение: номера трамваев
 
 public:
-    // Основные методы согласно заданию:
-    void createTram(const vector<string>& args);       // CREATE_TRAM
-    void showTramsAtStop(const vector<string>& args);  // TRAMS_IN_STOP
-    void showStopsForTram(const vector<string>& args);  // STOPS_IN_TRAM
-    void displayAllTrams();                            // TRAMS
+    // Основные методы согласно заданию
+    // (результат выводится в переданный поток, по умолчанию - в cout):
+    void createTram(const vector<string>& args, ostream& out = cout);       // CREATE_TRAM
+    void showTramsAtStop(const vector<string>& args, ostream& out = cout);  // TRAMS_IN_STOP
+    void showStopsForTram(const vector<string>& args, ostream& out = cout);  // STOPS_IN_TRAM
+    void displayAllTrams(ostream& out = cout);                             // TRAMS
 };
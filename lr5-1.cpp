@@ -3,6 +3,8 @@
 #include <map>
 #include <vector>
 #include <iomanip>
+#include <sstream>
+#include "CommandEngine.h"
 
 using namespace std;
 
@@ -60,32 +62,32 @@ public:
     }
 
     // Метод для добавления товара
-    void addItem(const string& name, int count, const string& addr) {
+    void addItem(const string& name, int count, const string& addr, ostream& out = cout) {
         Cell& cell = getCell(addr);
         int freeSpace = 10 - cell.count; // Свободное место в ячейке
         if (count > freeSpace) {
-            cout << "Недостаточно места в ячейке.\n";
+            out << "Недостаточно места в ячейке.\n";
             return;
         }
         cell.name = name; // Название товара
         cell.count += count; // Увеличение количества
         updateUsage(); // Обновление общего использования
-        cout << "Товар добавлен.\n";
+        out << "Товар добавлен.\n";
     }
 
     // Метод для удаления товара
-    void removeItem(const string& name, int count, const string& addr) {
+    void removeItem(const string& name, int count, const string& addr, ostream& out = cout) {
         Cell& cell = getCell(addr);
         // Проверка, есть ли товар и достаточно ли его
         if (cell.count < count || cell.name != name) {
-            cout << "Недостаточно товара для списания.\n";
+            out << "Недостаточно товара для списания.\n";
             return;
         }
         cell.count -= count; // Уменьшаем количество
         if (cell.count == 0)
             cell.name = ""; // Очистка ячейки, если товар полностью списан
         updateUsage(); // Обновление общего использования
-        cout << "Товар удален.\n";
+        out << "Товар удален.\n";
     }
 
     // Получение ссылки на ячейку по адресу
@@ -103,12 +105,12 @@ public:
     }
 
     // Метод для вывода информации о состоянии склада
-    void info() {
+    void info(ostream& out = cout) {
         // Расчет общего процента заполнения
         double percentTotal = (double)totalUsed / totalCapacity * 100;
 
-        cout << fixed << setprecision(2);
-        cout << "Общий процент заполнения склада: " << percentTotal << "%\n";
+        out << fixed << setprecision(2);
+        out << "Общий процент заполнения склада: " << percentTotal << "%\n";
 
         // Расчет заполненности каждой зоны
         int zoneCount = 2; // по условию
@@ -125,37 +127,37 @@ public:
                     zoneUsed += it->second.count;
             }
             double zonePercent = (double)zoneUsed / totalCapacity * 100;
-            cout << "Зона " << (char)('A' + z) << " заполнена на " << zonePercent << "%\n";
+            out << "Зона " << (char)('A' + z) << " заполнена на " << zonePercent << "%\n";
         }
 
         // Вывод ячеек с товаром
-        cout << "Ячейки с товаром:\n";
+        out << "Ячейки с товаром:\n";
         bool hasItems = false;
         for (auto& pair : cells) {
             if (pair.second.count > 0) {
-                cout << "Адрес: " << pair.first << ", Товар: " << pair.second.name
+                out << "Адрес: " << pair.first << ", Товар: " << pair.second.name
                      << ", Количество: " << pair.second.count << "\n";
                 hasItems = true;
             }
         }
         if (!hasItems)
-            cout << "Нет товаров на складе.\n";
+            out << "Нет товаров на складе.\n";
 
         // Вывод пустых ячеек через запятую
-        cout << "Пустые ячейки: ";
+        out << "Пустые ячейки: ";
         bool firstEmpty = true;
         for (auto& addr : allAddresses) {
             auto it = cells.find(addr);
             if (it == cells.end() || it->second.count == 0) {
                 if (!firstEmpty)
-                    cout << ", ";
-                cout << addr;
+                    out << ", ";
+                out << addr;
                 firstEmpty = false;
             }
         }
         if (firstEmpty)
-            cout << "Все ячейки заняты.";
-        cout << "\n";
+            out << "Все ячейки заняты.";
+        out << "\n";
     }
 };
 
@@ -169,31 +171,46 @@ int main() {
     cout << "ADD <наименование> <количество> <адрес>\n";
     cout << "REMOVE <наименование> <количество> <адрес>\n";
     cout << "INFO\n";
+    cout << "STATS\n";
     cout << "EXIT\n";
 
-    string cmd;
-    while (true) {
-        cout << "\nВведите команду: ";
-        cin >> cmd;
-
-        if (cmd == "EXIT") {
-            break; // Выход из программы
-        } else if (cmd == "ADD") {
-            string name, addr;
-            int count;
-            cin >> name >> count >> addr;
-            wh.addItem(name, count, addr);
-        } else if (cmd == "REMOVE") {
-            string name, addr;
-            int count;
-            cin >> name >> count >> addr;
-            wh.removeItem(name, count, addr);
-        } else if (cmd == "INFO") {
-            wh.info(); // Вывод состояния склада
-        } else {
-            cout << "Неверная команда.\n";
+    // регистрация команд
+    CommandEngine engine;
+    istringstream args; // разбор параметров; один поток на все команды дешевле, чем новый на каждую
+    engine.setPrompt("\nВведите команду: ");
+    engine.on("EXIT", [&](const Request&, ostream&, ostream&) {
+        engine.stop(); // Выход из программы
+    });
+    engine.on("ADD", [&](const Request& req, ostream& out, ostream&) {
+        string name, addr;
+        int count;
+        args.clear();
+        args.str(req.params);
+        if (!(args >> name >> count >> addr)) {
+            out << "Неверный формат команды.\n";
+            return;
         }
-    }
+        wh.addItem(name, count, addr, out);
+    });
+    engine.on("REMOVE", [&](const Request& req, ostream& out, ostream&) {
+        string name, addr;
+        int count;
+        args.clear();
+        args.str(req.params);
+        if (!(args >> name >> count >> addr)) {
+            out << "Неверный формат команды.\n";
+            return;
+        }
+        wh.removeItem(name, count, addr, out);
+    });
+    engine.on("INFO", [&](const Request&, ostream& out, ostream&) {
+        wh.info(out); // Вывод состояния склада
+    });
+    engine.onUnknown([](const Request&, ostream& out, ostream&) {
+        out << "Неверная команда.\n";
+    });
+
+    engine.run();
 
     return 0;
 }
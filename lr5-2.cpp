@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <sstream>
 #include <ctime>
+#include "CommandEngine.h"
 
 using namespace std;
 
@@ -30,12 +31,13 @@ struct Visitor {
 };
 
 // функция вывода справки по командам
-void printHelp() {
-    cout << "\nдоступные команды:\n";
-    cout << "ENQUEUE <минуты> - добавить посетителя в очередь\n";
-    cout << "DISTRIBUTE       - распределить очередь по окнам\n";
-    cout << "HELP             - показать эту справку\n";
-    cout << "EXIT             - завершить программу\n\n";
+void printHelp(ostream& out = cout) {
+    out << "\nдоступные команды:\n";
+    out << "ENQUEUE <минуты> - добавить посетителя в очередь\n";
+    out << "DISTRIBUTE       - распределить очередь по окнам\n";
+    out << "STATS            - статистика выполнения команд\n";
+    out << "HELP             - показать эту справку\n";
+    out << "EXIT             - завершить программу\n\n";
 }
 
 // главная функция программы
@@ -54,97 +56,96 @@ int main() {
     // выводим справку по командам
     printHelp();
     
-    string command;  // переменная для хранения введенной команды
+    CommandEngine engine;
+    engine.setPrompt("> введите команду: ");
+    istringstream args; // разбор параметров; один поток на все команды дешевле, чем новый на каждую
     
-    // основной цикл программы
-    while (true) {
-        cout << "> введите команду: ";
-        cin >> command;
+    // обработка команды добавления посетителя
+    engine.on("ENQUEUE", [&](const Request& req, ostream& out, ostream&) {
+        int duration;
         
-        // обработка команды добавления посетителя
-        if (command == "ENQUEUE") {
-            int duration;
-            
-            // проверяем корректность ввода продолжительности
-            if (!(cin >> duration)) {
-                cout << "! ошибка: введите число минут после команды ENQUEUE\n";
-                cin.clear();          // сбрасываем флаги ошибок
-                cin.ignore(10000, '\n');  // очищаем буфер ввода
-                continue;
-            }
-            
-            // создаем нового посетителя
-            Visitor v = {genTicket(), duration};
-            
-            // добавляем посетителя в очередь
-            queue.push_back(v);
-            
-            // выводим подтверждение добавления
-            cout << "> добавлен посетитель с талоном " << v.ticket 
-                 << " (" << duration << " минут)\n";
-            
-        } 
-        // обработка команды распределения очереди
-        else if (command == "DISTRIBUTE") {
-            // проверяем, есть ли посетители в очереди
-            if (queue.empty()) {
-                cout << "! очередь пуста, нечего распределять\n";
-                continue;
-            }
-            
-            // создаем вектор для хранения информации по окнам
-            // каждый элемент - пара: общее время и список посетителей
-            vector<pair<int, vector<Visitor>>> win(windows);
+        // проверяем корректность ввода продолжительности
+        args.clear();
+        args.str(req.params);
+        if (!(args >> duration)) {
+            out << "! ошибка: введите число минут после команды ENQUEUE\n";
+            return;
+        }
+        
+        // создаем нового посетителя
+        Visitor v = {genTicket(), duration};
+        
+        // добавляем посетителя в очередь
+        queue.push_back(v);
+        
+        // выводим подтверждение добавления
+        out << "> добавлен посетитель с талоном " << v.ticket 
+            << " (" << duration << " минут)\n";
+    });
+    
+    // обработка команды распределения очереди
+    engine.on("DISTRIBUTE", [&](const Request&, ostream& out, ostream&) {
+        // проверяем, есть ли посетители в очереди
+        if (queue.empty()) {
+            out << "! очередь пуста, нечего распределять\n";
+            return;
+        }
+        
+        // создаем вектор для хранения информации по окнам
+        // каждый элемент - пара: общее время и список посетителей
+        vector<pair<int, vector<Visitor>>> win(windows);
+        
+        // распределяем посетителей по окнам
+        for (const auto& vis : queue) {
+            // находим окно с минимальным текущим временем
+            auto minWin = min_element(win.begin(), win.end(),
+                [](const auto& a, const auto& b) {
+                    return a.first < b.first;
+                });
             
-            // распределяем посетителей по окнам
-            for (const auto& vis : queue) {
-                // находим окно с минимальным текущим временем
-                auto minWin = min_element(win.begin(), win.end(),
-                    [](const auto& a, const auto& b) {
-                        return a.first < b.first;
-                    });
-                
-                // добавляем посетителя в это окно
-                minWin->first += vis.duration;       // увеличиваем общее время
-                minWin->second.push_back(vis);        // добавляем посетителя
-            }
+            // добавляем посетителя в это окно
+            minWin->first += vis.duration;       // увеличиваем общее время
+            minWin->second.push_back(vis);        // добавляем посетителя
+        }
+        
+        // выводим результаты распределения
+        out << "\n=== результаты распределения ===\n";
+        for (int i = 0; i < windows; ++i) {
+            out << "окно " << i+1 << " (общее время: " << win[i].first 
+                << " мин): ";
             
-            // выводим результаты распределения
-            cout << "\n=== результаты распределения ===\n";
-            for (int i = 0; i < windows; ++i) {
-                cout << "окно " << i+1 << " (общее время: " << win[i].first 
-                     << " мин): ";
-                
-                // выводим список талонов для этого окна
-                bool first = true;
-                for (const auto& vis : win[i].second) {
-                    if (!first) cout << ", ";
-                    cout << vis.ticket << " (" << vis.duration << " мин)";
-                    first = false;
-                }
-                cout << "\n";
+            // выводим список талонов для этого окна
+            bool first = true;
+            for (const auto& vis : win[i].second) {
+                if (!first) out << ", ";
+                out << vis.ticket << " (" << vis.duration << " мин)";
+                first = false;
             }
-            cout << "===============================\n";
-            
-            break;  // завершаем работу после распределения
-            
-        } 
-        // обработка команды вывода справки
-        else if (command == "HELP") {
-            printHelp();
-            
-        } 
-        // обработка команды выхода
-        else if (command == "EXIT") {
-            cout << "завершение работы программы.\n";
-            return 0;
-            
-        } 
-        // обработка неизвестной команды
-        else {
-            cout << "! неизвестная команда. введите HELP для списка команд\n";
+            out << "\n";
         }
-    }
+        out << "===============================\n";
+        
+        engine.stop();  // завершаем работу после распределения
+    });
+    
+    // обработка команды вывода справки
+    engine.on("HELP", [](const Request&, ostream& out, ostream&) {
+        printHelp(out);
+    });
+    
+    // обработка команды выхода
+    engine.on("EXIT", [&](const Request&, ostream& out, ostream&) {
+        out << "завершение работы программы.\n";
+        engine.stop();
+    });
+    
+    // обработка неизвестной команды
+    engine.onUnknown([](const Request&, ostream& out, ostream&) {
+        out << "! неизвестная команда. введите HELP для списка команд\n";
+    });
+    
+    // основной цикл программы
+    engine.run();
     
     return 0;
 }
@@ -1,176 +1,597 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <map>
+#include <optional>
+#include <array>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <charconv>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "CommandEngine.h"
 
 using namespace std;
 
+// файлы для хранения данных между запусками программы
+const string JOURNAL_FILE = "regions.journal";   // журнал изменений (только дозапись)
+const string SNAPSHOT_FILE = "regions.snapshot"; // сжатый снимок всей истории
+const uint64_t SNAPSHOT_MIN_JOURNAL = 64 * 1024; // журнал меньше этого размера не сворачивается в снимок
+
+// ограничения, защищающие от выделения гигабайт по испорченному полю длины
+const uint32_t MAX_NAME_LENGTH = 64 * 1024;                      // название региона или центра
+const uint32_t MAX_RECORD_SIZE = 1 + 8 + 2 * (4 + MAX_NAME_LENGTH); // тело записи журнала
+
+// типы записей в журнале
+const uint8_t REC_CHANGE = 1;
+const uint8_t REC_RENAME = 2;
+
+// сигнатура файла снимка
+const char SNAPSHOT_MAGIC[4] = {'R', 'G', 'S', '1'};
+
+// вспомогательные функции двоичной записи/чтения
+void writeU8(ostream& out, uint8_t v) { out.put((char)v); }
+void writeU32(ostream& out, uint32_t v) { out.write((const char*)&v, sizeof(v)); }
+void writeU64(ostream& out, uint64_t v) { out.write((const char*)&v, sizeof(v)); }
+void writeStr(ostream& out, const string& s) {
+    writeU32(out, (uint32_t)s.size());
+    out.write(s.data(), s.size());
+}
+
+bool readU8(istream& in, uint8_t& v) {
+    char c;
+    if (!in.get(c)) return false;
+    v = (uint8_t)c;
+    return true;
+}
+bool readU32(istream& in, uint32_t& v) { return (bool)in.read((char*)&v, sizeof(v)); }
+bool readU64(istream& in, uint64_t& v) { return (bool)in.read((char*)&v, sizeof(v)); }
+bool readStr(istream& in, string& s) {
+    uint32_t len;
+    if (!readU32(in, len) || len > MAX_NAME_LENGTH) return false;
+    s.resize(len);
+    return (bool)in.read(&s[0], len);
+}
+
+// контрольная сумма CRC-32 (полином 0xEDB88320, как в zip и gzip)
+uint32_t crc32(const string& data) {
+    static const auto table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char ch : data) crc = table[(crc ^ ch) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// хранилище регионов с историей версий
+// каждая успешная команда CHANGE/RENAME увеличивает номер версии на 1;
+// для каждого региона хранится упорядоченная по версиям история его центра,
+// поэтому запрос "ABOUT <регион> AT <версия>" выполняется за O(log n)
+// без повторного проигрывания журнала
+class RegionStore {
+    // текущее состояние: регион - административный центр
+    map<string, string> regions;
+
+    // история: регион -> (версия -> центр), nullopt - регион удален (переименован)
+    map<string, map<uint64_t, optional<string>>> history;
+
+    // Гарантии сохранности: запись журнала передается системе до ответа на команду,
+    // поэтому падение программы не теряет ни одной выполненной команды. fsync делается
+    // только при сворачивании журнала в снимок: после сбоя системы или питания могут
+    // пропасть команды после последнего снимка (их хвост отбросится как оборванный),
+    // но не более ранняя история.
+    uint64_t version = 0;       // номер текущей версии
+    uint64_t journalBytes = 0;  // размер журнала после последнего снимка
+    uint64_t snapshotBytes = 0; // размер последнего снимка
+    int journalFd = -1;         // журнал, открытый на дозапись и заблокированный (flock)
+    bool loaded = true;         // данные прошлых запусков восстановлены без пропусков
+
+    // применение изменений к памяти (без записи в журнал)
+    void applyChange(uint64_t ver, const string& reg, const string& cntr) {
+        regions[reg] = cntr;
+        history[reg][ver] = cntr;
+        version = ver;
+    }
+
+    void applyRename(uint64_t ver, const string& oldReg, const string& newReg) {
+        string cntr = regions[oldReg];
+        regions.erase(oldReg);
+        regions[newReg] = cntr;
+        history[oldReg][ver] = nullopt;
+        history[newReg][ver] = cntr;
+        version = ver;
+    }
+
+    // загрузка снимка; возвращает false, если снимка нет или он поврежден
+    bool loadSnapshot() {
+        ifstream in(SNAPSHOT_FILE, ios::binary);
+        if (!in) return false;
+
+        char magic[4];
+        uint64_t ver;
+        uint32_t keyCount;
+        if (!in.read(magic, 4) || !equal(magic, magic + 4, SNAPSHOT_MAGIC)
+            || !readU64(in, ver) || !readU32(in, keyCount)) {
+            return false;
+        }
+
+        map<string, map<uint64_t, optional<string>>> loaded;
+        for (uint32_t k = 0; k < keyCount; ++k) {
+            string reg;
+            uint32_t entryCount;
+            if (!readStr(in, reg) || !readU32(in, entryCount)) return false;
+            auto& entries = loaded[reg];
+            for (uint32_t e = 0; e < entryCount; ++e) {
+                uint64_t entryVer;
+                uint8_t present;
+                string cntr;
+                if (!readU64(in, entryVer) || !readU8(in, present) || !readStr(in, cntr)) return false;
+                entries.emplace_hint(entries.end(), entryVer,
+                                     present ? optional<string>(cntr) : nullopt);
+            }
+        }
+
+        // восстанавливаем текущее состояние из последних записей истории
+        history = move(loaded);
+        regions.clear();
+        for (const auto& [reg, entries] : history) {
+            if (!entries.empty() && entries.rbegin()->second) {
+                regions[reg] = *entries.rbegin()->second;
+            }
+        }
+        version = ver;
+        snapshotBytes = (uint64_t)in.tellg();
+        return true;
+    }
+
+    // проигрывание журнала поверх снимка; записи с версией не выше текущей пропускаются
+    // (они уже попали в снимок). Запись журнала: длина тела, CRC-32 тела, тело
+    // (тип, версия, две строки). Неполная запись в самом конце файла - след
+    // прерванной дозаписи, она отрезается; любая другая ошибка останавливает запуск.
+    void replayJournal() {
+        ifstream in(JOURNAL_FILE, ios::binary | ios::ate);
+        if (!in) return;
+        uint64_t fileSize = (uint64_t)in.tellg();
+        in.seekg(0);
+
+        uint64_t goodEnd = 0;
+        while (goodEnd < fileSize) {
+            uint32_t size, crc;
+            string body;
+            if (fileSize - goodEnd < 8) break; // оборванный заголовок
+            readU32(in, size);
+            readU32(in, crc);
+            if (size == 0 || size > MAX_RECORD_SIZE) {
+                journalError(goodEnd, "неверная длина записи");
+                return;
+            }
+            if (fileSize - goodEnd - 8 < size) break; // оборванное тело
+            body.resize(size);
+            in.read(&body[0], size);
+            if (crc32(body) != crc) {
+                journalError(goodEnd, "не совпадает контрольная сумма");
+                return;
+            }
+
+            istringstream rec(body);
+            uint8_t type;
+            uint64_t ver;
+            string a, b;
+            if (!readU8(rec, type) || !readU64(rec, ver) || !readStr(rec, a) || !readStr(rec, b)
+                || rec.peek() != EOF || (type != REC_CHANGE && type != REC_RENAME)) {
+                journalError(goodEnd, "неверный формат записи");
+                return;
+            }
+
+            if (ver > version) {
+                // версии в журнале идут подряд; пропуск означает, что потерян снимок
+                // или часть журнала, и частичная история хуже, чем отказ от запуска
+                if (ver != version + 1) {
+                    cerr << "Ошибка: в журнале " << JOURNAL_FILE << " после версии " << version
+                         << " идет версия " << ver << ", часть истории потеряна.\n";
+                    loaded = false;
+                    return;
+                }
+                if (type == REC_CHANGE) applyChange(ver, a, b);
+                else applyRename(ver, a, b);
+            }
+            goodEnd += 8 + size;
+        }
+        journalBytes = goodEnd;
+
+        // обрезаем оборванную последнюю запись, чтобы новые записи шли сразу за последней целой
+        if (fileSize > goodEnd) {
+            cerr << "Предупреждение: последняя запись журнала " << JOURNAL_FILE
+                 << " не дописана (" << fileSize - goodEnd << " байт) и отброшена.\n";
+            if (ftruncate(journalFd, (off_t)goodEnd) != 0) {
+                cerr << "Ошибка: не удалось обрезать журнал " << JOURNAL_FILE << "\n";
+                loaded = false;
+            }
+        }
+    }
+
+    void journalError(uint64_t offset, const char* reason) {
+        cerr << "Ошибка: журнал " << JOURNAL_FILE << " поврежден (смещение " << offset
+             << ": " << reason << "), запуск невозможен без потери истории.\n";
+        loaded = false;
+    }
+
+    // сброс файла на диск; для каталога гарантирует сохранность переименования
+    static bool syncPath(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+        bool ok = fsync(fd) == 0;
+        close(fd);
+        return ok;
+    }
+
+    void appendRecord(uint8_t type, const string& a, const string& b) {
+        ostringstream body;
+        writeU8(body, type);
+        writeU64(body, version);
+        writeStr(body, a);
+        writeStr(body, b);
+
+        string bodyStr = body.str();
+        ostringstream rec;
+        writeU32(rec, (uint32_t)bodyStr.size());
+        writeU32(rec, crc32(bodyStr));
+        rec << bodyStr;
+
+        // запись должна попасть в файл до ответа пользователю
+        string data = rec.str();
+        if (journalFd == -1 || write(journalFd, data.data(), data.size()) != (ssize_t)data.size()) {
+            cerr << "Ошибка: не удалось записать изменение в журнал " << JOURNAL_FILE << "\n";
+            return;
+        }
+        journalBytes += data.size();
+
+        // снимок переписывает всю историю, поэтому делается, когда журнал дорос до половины
+        // снимка: суммарный объем записи снимков остается линейным по числу команд
+        if (journalBytes >= SNAPSHOT_MIN_JOURNAL && journalBytes * 2 >= snapshotBytes) {
+            saveSnapshot();
+        }
+    }
+
+    // запись сжатого снимка: сначала во временный файл, затем атомарная замена,
+    // после чего журнал можно очистить
+    void saveSnapshot() {
+        string tmpFile = SNAPSHOT_FILE + ".tmp";
+        {
+            ofstream out(tmpFile, ios::binary | ios::trunc);
+            out.write(SNAPSHOT_MAGIC, 4);
+            writeU64(out, version);
+            writeU32(out, (uint32_t)history.size());
+            for (const auto& [reg, entries] : history) {
+                writeStr(out, reg);
+                writeU32(out, (uint32_t)entries.size());
+                for (const auto& [ver, cntr] : entries) {
+                    writeU64(out, ver);
+                    writeU8(out, cntr ? 1 : 0);
+                    writeStr(out, cntr ? *cntr : "");
+                }
+            }
+            if (!out) {
+                cerr << "Ошибка: не удалось записать снимок " << tmpFile << "\n";
+                return;
+            }
+            snapshotBytes = (uint64_t)out.tellp();
+        }
+        // журнал очищается только после того, как снимок гарантированно на диске
+        if (!syncPath(tmpFile)) {
+            cerr << "Ошибка: не удалось сохранить на диск снимок " << tmpFile << "\n";
+            return;
+        }
+        if (rename(tmpFile.c_str(), SNAPSHOT_FILE.c_str()) != 0) {
+            cerr << "Ошибка: не удалось заменить снимок " << SNAPSHOT_FILE << "\n";
+            return;
+        }
+        if (!syncPath(".")) {
+            cerr << "Ошибка: не удалось сохранить на диск каталог со снимком\n";
+            return;
+        }
+
+        if (ftruncate(journalFd, 0) != 0) {
+            cerr << "Ошибка: не удалось очистить журнал " << JOURNAL_FILE << "\n";
+            return;
+        }
+        journalBytes = 0;
+    }
+
+    // открытие журнала с эксклюзивной блокировкой: два экземпляра программы
+    // в одном каталоге перемешали бы записи и номера версий
+    bool openJournal() {
+        journalFd = open(JOURNAL_FILE.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (journalFd == -1) {
+            cerr << "Ошибка: не удалось открыть журнал " << JOURNAL_FILE << "\n";
+            return false;
+        }
+        if (flock(journalFd, LOCK_EX | LOCK_NB) != 0) {
+            cerr << "Ошибка: журнал " << JOURNAL_FILE
+                 << " уже используется другим экземпляром программы.\n";
+            return false;
+        }
+        return true;
+    }
+
+public:
+    // загрузка данных предыдущих запусков: снимок + хвост журнала
+    // при любой ошибке журнал не трогаем, чтобы не затереть оставшиеся данные
+    RegionStore() {
+        if (!openJournal()) {
+            loaded = false;
+            return;
+        }
+        if (!loadSnapshot() && ifstream(SNAPSHOT_FILE)) {
+            cerr << "Предупреждение: снимок " << SNAPSHOT_FILE
+                 << " поврежден, история восстанавливается только из журнала.\n";
+        }
+        replayJournal();
+    }
+
+    ~RegionStore() {
+        if (journalFd != -1) close(journalFd);
+    }
+
+    RegionStore(const RegionStore&) = delete;
+    RegionStore& operator=(const RegionStore&) = delete;
+
+    bool isLoaded() const { return loaded; }
+
+    uint64_t currentVersion() const { return version; }
+
+    const map<string, string>& all() const { return regions; }
+
+    bool contains(const string& reg) const { return regions.find(reg) != regions.end(); }
+
+    const string& center(const string& reg) const { return regions.at(reg); }
+
+    // CHANGE: создание или изменение региона
+    void change(const string& reg, const string& cntr) {
+        applyChange(version + 1, reg, cntr);
+        appendRecord(REC_CHANGE, reg, cntr);
+    }
+
+    // RENAME: переименование существующего региона
+    void renameRegion(const string& oldReg, const string& newReg) {
+        applyRename(version + 1, oldReg, newReg);
+        appendRecord(REC_RENAME, oldReg, newReg);
+    }
+
+    // центр региона в заданной версии; nullopt - региона в этой версии не было
+    optional<string> centerAt(const string& reg, uint64_t ver) const {
+        auto it = history.find(reg);
+        if (it == history.end()) return nullopt;
+
+        // последняя запись с версией <= ver
+        auto entry = it->second.upper_bound(ver);
+        if (entry == it->second.begin()) return nullopt;
+        return prev(entry)->second;
+    }
+};
+
 // функция для вывода списка доступных команд
-void printHelp() {
-    cout << "Доступные команды:" << endl;
-    cout << "CHANGE <регион> <центр> - создать/изменить регион" << endl;
-    cout << "RENAME <старое_имя> <новое_имя> - переименовать регион" << endl;
-    cout << "ABOUT <регион> - информация о регионе" << endl;
-    cout << "ALL - список всех регионов" << endl;
-    cout << "HELP - справка по командам" << endl;
-    cout << "EXIT - выход из программы" << endl;
+void printHelp(ostream& out = cout) {
+    out << "Доступные команды:" << endl;
+    out << "CHANGE <регион> <центр> - создать/изменить регион" << endl;
+    out << "RENAME <старое_имя> <новое_имя> - переименовать регион" << endl;
+    out << "ABOUT <регион> - информация о регионе" << endl;
+    out << "ABOUT <регион> AT <версия> - информация о регионе в указанной версии" << endl;
+    out << "ALL - список всех регионов" << endl;
+    out << "STATS - статистика выполнения команд" << endl;
+    out << "HELP - справка по командам" << endl;
+    out << "EXIT - выход из программы" << endl;
 }
 
 int main() {
-    // создаем контейнер для хранения данных о регионах
-    // map хранит пары "ключ-значение" (регион - административный центр)
-    // и автоматически сортирует их по ключу
-    map<string, string> regions;
+    // создаем хранилище данных о регионах
+    // внутри map хранит пары "ключ-значение" (регион - административный центр)
+    // и автоматически сортирует их по ключу; изменения сохраняются в журнал
+    RegionStore regions;
+    if (!regions.isLoaded()) {
+        cerr << "Ошибка: данные о регионах восстановлены не полностью, работа прервана.\n";
+        return 1;
+    }
 
     // выводим справочную информацию при запуске
     printHelp();
+    cout << "Текущая версия данных: " << regions.currentVersion() << endl;
 
-    // основной цикл программы - выполняется пока пользователь не введет EXIT
-    while(true) {
-        cout << "> Введите команду (или HELP): "; // приглашение ко вводу
-        
-        string query; // переменная для хранения введенной команды
-        getline(cin, query); // считываем всю строку ввода
+    // регистрация команд; название команды приводится к верхнему регистру
+    // для унификации сравнения
+    CommandEngine engine;
+    engine.setCaseInsensitive(true);
+    engine.setPrompt("> Введите команду (или HELP): "); // приглашение ко вводу
+    
+    // если введена пустая строка - сообщаем об ошибке
+    engine.onEmpty([](const Request&, ostream& out, ostream&) {
+        out << "Ошибка: пустой ввод. Повторите попытку.\n";
+    });
+    
+    engine.on("EXIT", [&](const Request&, ostream& out, ostream&) {
+        out << "=== Завершение работы программы ===\n";
+        engine.stop(); // выход из основного цикла
+    });
+    
+    engine.on("HELP", [](const Request&, ostream& out, ostream&) {
+        printHelp(out); // вызываем функцию вывода справки
+    });
+    
+    engine.on("CHANGE", [&](const Request& req, ostream& out, ostream& err) {
+        // ищем разделитель между названием региона и центром
+        size_t sep = req.params.find(' ');
         
-        // если введена пустая строка - пропускаем итерацию
-        if(query.empty()) {
-            cout << "Ошибка: пустой ввод. Повторите попытку.\n";
-            continue;
+        // проверка корректности ввода параметров
+        if(sep == string::npos) {
+            err << "Ошибка: неверный формат команды.\n";
+            err << "Используйте: CHANGE <регион> <центр>\n";
+            return;
         }
         
-        // находим позицию первого пробела для разделения команды и параметров
-        size_t spacePos = query.find(' ');
-        string command = query.substr(0, spacePos); // извлекаем саму команду
-        string params = spacePos != string::npos ? query.substr(spacePos + 1) : "";
+        // извлекаем название региона и административного центра
+        string reg = req.params.substr(0, sep);
+        string cntr = req.params.substr(sep + 1);
+        if(reg.size() > MAX_NAME_LENGTH || cntr.size() > MAX_NAME_LENGTH) {
+            err << "Ошибка: название длиннее " << MAX_NAME_LENGTH << " байт.\n";
+            return;
+        }
         
-        // преобразуем команду в верхний регистр для унификации сравнения
-        transform(command.begin(), command.end(), command.begin(), ::toupper);
-
-        if(command == "EXIT") {
-            cout << "=== Завершение работы программы ===\n";
-            break; // выход из цикла while
+        // проверка существования региона в контейнере
+        if(regions.contains(reg)) {
+            // если регион существует - обновляем его центр
+            string oldCntr = regions.center(reg); // сохраняем старый центр
+            regions.change(reg, cntr); // устанавливаем новый центр
+            
+            // формируем информативное сообщение об изменении
+            out << "=== Изменение административного центра ===\n";
+            out << "Регион: " << reg << "\n";
+            out << "Старый центр: " << oldCntr << "\n";
+            out << "Новый центр: " << cntr << "\n";
+        } else {
+            // если регион не существует - добавляем новую запись
+            regions.change(reg, cntr);
+            
+            // формируем сообщение о создании нового региона
+            out << "=== Добавлен новый регион ===\n";
+            out << "Регион: " << reg << "\n";
+            out << "Административный центр: " << cntr << "\n";
         }
+        out << "Версия: " << regions.currentVersion() << "\n";
+    });
+    
+    engine.on("RENAME", [&](const Request& req, ostream& out, ostream& err) {
+        size_t sep = req.params.find(' ');
         
-        if(command == "HELP") {
-            printHelp(); // вызываем функцию вывода справки
-            continue; // переходим к следующей итерации
+        // проверка наличия обоих параметров
+        if(sep == string::npos) {
+            err << "Ошибка: неверный формат команды.\n";
+            err << "Используйте: RENAME <старое_имя> <новое_имя>\n";
+            return;
         }
         
-        if(command == "CHANGE") {
-            // ищем разделитель между названием региона и центром
-            size_t sep = params.find(' ');
-            
-            // проверка корректности ввода параметров
-            if(sep == string::npos) {
-                cerr << "Ошибка: неверный формат команды.\n";
-                cerr << "Используйте: CHANGE <регион> <центр>\n";
-                continue;
-            }
-            
-            // извлекаем название региона и административного центра
-            string reg = params.substr(0, sep);
-            string cntr = params.substr(sep + 1);
+        // извлекаем старое и новое варианты названия
+        string oldReg = req.params.substr(0, sep);
+        string newReg = req.params.substr(sep + 1);
+        
+        // проверка всех возможных ошибок:
+        if(newReg.size() > MAX_NAME_LENGTH) {
+            err << "Ошибка: название длиннее " << MAX_NAME_LENGTH << " байт.\n";
+        } else if(!regions.contains(oldReg)) {
+            err << "Ошибка: регион '" << oldReg << "' не найден.\n";
+        } else if(oldReg == newReg) {
+            err << "Ошибка: новое название совпадает со старым.\n";
+        } else if(regions.contains(newReg)) {
+            err << "Ошибка: регион '" << newReg << "' уже существует.\n";
+        } else {
+            // если все проверки пройдены - выполняем переименование
+            string cntr = regions.center(oldReg); // сохраняем центр
+            regions.renameRegion(oldReg, newReg); // переносим запись под новым именем
             
-            // проверка существования региона в контейнере
-            if(regions.find(reg) != regions.end()) {
-                // если регион существует - обновляем его центр
-                string oldCntr = regions[reg]; // сохраняем старый центр
-                regions[reg] = cntr; // устанавливаем новый центр
-                
-                // формируем информативное сообщение об изменении
-                cout << "=== Изменение административного центра ===\n";
-                cout << "Регион: " << reg << "\n";
-                cout << "Старый центр: " << oldCntr << "\n";
-                cout << "Новый центр: " << cntr << "\n";
-            } else {
-                // если регион не существует - добавляем новую запись
-                regions[reg] = cntr;
-                
-                // формируем сообщение о создании нового региона
-                cout << "=== Добавлен новый регион ===\n";
-                cout << "Регион: " << reg << "\n";
-                cout << "Административный центр: " << cntr << "\n";
-            }
+            // выводим подробное сообщение о результате
+            out << "=== Регион успешно переименован ===\n";
+            out << "Старое название: " << oldReg << "\n";
+            out << "Новое название: " << newReg << "\n";
+            out << "Административный центр сохранен: " << cntr << "\n";
+            out << "Версия: " << regions.currentVersion() << "\n";
         }
-        else if(command == "RENAME") {
-            size_t sep = params.find(' ');
-            
-            // проверка наличия обоих параметров
-            if(sep == string::npos) {
-                cerr << "Ошибка: неверный формат команды.\n";
-                cerr << "Используйте: RENAME <старое_имя> <новое_имя>\n";
-                continue;
-            }
-            
-            // извлекаем старое и новое варианты названия
-            string oldReg = params.substr(0, sep);
-            string newReg = params.substr(sep + 1);
+    });
+    
+    engine.on("ABOUT", [&](const Request& req, ostream& out, ostream& err) {
+        // проверка наличия параметра
+        if(req.params.empty()) {
+            err << "Ошибка: укажите название региона.\n";
+            err << "Используйте: ABOUT <регион>\n";
+            return;
+        }
+        
+        // запрос к истории: ABOUT <регион> AT <версия>;
+        // AT, как и сама команда, распознается в любом регистре
+        string upper = req.params;
+        transform(upper.begin(), upper.end(), upper.begin(),
+                  [](unsigned char c) { return c < 128 ? (char)toupper(c) : (char)c; });
+        size_t atPos = upper.rfind(" AT ");
+        if(atPos != string::npos) {
+            string reg = req.params.substr(0, atPos);
+            string verStr = req.params.substr(atPos + 4);
             
-            // проверка всех возможных ошибок:
-            if(regions.find(oldReg) == regions.end()) {
-                cerr << "Ошибка: регион '" << oldReg << "' не найден.\n";
-            } else if(oldReg == newReg) {
-                cerr << "Ошибка: новое название совпадает со старым.\n";
-            } else if(regions.find(newReg) != regions.end()) {
-                cerr << "Ошибка: регион '" << newReg << "' уже существует.\n";
-            } else {
-                // если все проверки пройдены - выполняем переименование
-                string cntr = regions[oldReg]; // сохраняем центр
-                regions.erase(oldReg); // удаляем старую запись
-                regions[newReg] = cntr; // создаем новую запись
-                
-                // выводим подробное сообщение о результате
-                cout << "=== Регион успешно переименован ===\n";
-                cout << "Старое название: " << oldReg << "\n";
-                cout << "Новое название: " << newReg << "\n";
-                cout << "Административный центр сохранен: " << cntr << "\n";
+            // проверка, что версия - неотрицательное число без лишних символов
+            uint64_t ver;
+            auto [end, ec] = from_chars(verStr.data(), verStr.data() + verStr.size(), ver);
+            if(ec != errc() || end != verStr.data() + verStr.size()) {
+                err << "Ошибка: версия должна быть числом.\n";
+                err << "Используйте: ABOUT <регион> AT <версия>\n";
+                return;
             }
-        }
-        else if(command == "ABOUT") {
-            // проверка наличия параметра
-            if(params.empty()) {
-                cerr << "Ошибка: укажите название региона.\n";
-                cerr << "Используйте: ABOUT <регион>\n";
-                continue;
+            if(ver > regions.currentVersion()) {
+                err << "Ошибка: версия " << ver << " еще не существует (текущая: "
+                    << regions.currentVersion() << ").\n";
+                return;
             }
             
-            // проверка существования региона
-            if(regions.find(params) == regions.end()) {
-                cerr << "Ошибка: регион '" << params << "' не найден.\n";
+            optional<string> cntr = regions.centerAt(reg, ver);
+            if(!cntr) {
+                err << "Ошибка: регион '" << reg << "' не существовал в версии " << ver << ".\n";
             } else {
-                // вывод информации о регионе
-                cout << "=== Информация о регионе ===\n";
-                cout << "Регион: " << params << "\n";
-                cout << "Административный центр: " << regions[params] << "\n";
+                out << "=== Информация о регионе (версия " << ver << ") ===\n";
+                out << "Регион: " << reg << "\n";
+                out << "Административный центр: " << *cntr << "\n";
             }
+            return;
         }
-        else if(command == "ALL") {
-            // проверка на пустоту контейнера
-            if(regions.empty()) {
-                cout << "Список регионов пуст.\n";
-            } else {
-                // форматированный вывод всех регионов
-                cout << "=== Список всех регионов ===\n";
-                cout << "---------------------------------------------\n";
-                cout << "№  Регион\t\tАдминистративный центр\n";
-                cout << "---------------------------------------------\n";
-                
-                // используем range-based for loop для обхода контейнера
-                // с автоматической нумерацией, начиная с 1
-                int counter = 1;
-                for(const auto& [region, center] : regions) {
-                    cout << counter++ << ". " << region << "\t\t" << center << "\n";
-                }
-                cout << "---------------------------------------------\n";
-                cout << "Всего регионов: " << regions.size() << "\n";
-            }
+        
+        // проверка существования региона
+        if(!regions.contains(req.params)) {
+            err << "Ошибка: регион '" << req.params << "' не найден.\n";
+        } else {
+            // вывод информации о регионе
+            out << "=== Информация о регионе ===\n";
+            out << "Регион: " << req.params << "\n";
+            out << "Административный центр: " << regions.center(req.params) << "\n";
         }
-        // ===== обработка неизвестной команды =====
-        else {
-            cerr << "Ошибка: неизвестная команда '" << command << "'\n";
-            cerr << "Введите HELP для просмотра доступных команд.\n";
+    });
+    
+    engine.on("ALL", [&](const Request&, ostream& out, ostream&) {
+        // проверка на пустоту контейнера
+        if(regions.all().empty()) {
+            out << "Список регионов пуст.\n";
+        } else {
+            // форматированный вывод всех регионов
+            out << "=== Список всех регионов ===\n";
+            out << "---------------------------------------------\n";
+            out << "№  Регион\t\tАдминистративный центр\n";
+            out << "---------------------------------------------\n";
+            
+            // используем range-based for loop для обхода контейнера
+            // с автоматической нумерацией, начиная с 1
+            int counter = 1;
+            for(const auto& [region, center] : regions.all()) {
+                out << counter++ << ". " << region << "\t\t" << center << "\n";
+            }
+            out << "---------------------------------------------\n";
+            out << "Всего регионов: " << regions.all().size() << "\n";
+            out << "Текущая версия: " << regions.currentVersion() << "\n";
         }
-    }
+    });
+    
+    // ===== обработка неизвестной команды =====
+    engine.onUnknown([](const Request& req, ostream&, ostream& err) {
+        err << "Ошибка: неизвестная команда '" << req.command << "'\n";
+        err << "Введите HELP для просмотра доступных команд.\n";
+    });
+
+    // основной цикл программы - выполняется пока пользователь не введет EXIT
+    engine.run();
     
     return 0; // корректное завершение программы
 }
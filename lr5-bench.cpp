@@ -0,0 +1,438 @@
+// Сравнение реализаций на C++ и Rust (склад: lr5-1 / lr5-1r, очередь: lr5-2 / lr5-2r).
+// Генерирует большой детерминированный сценарий команд, запускает обе программы,
+// сверяет их ответы и выводит время работы, пиковую память и число команд в секунду.
+//
+// Тексты сообщений в реализациях различаются (регистр, точки, формулировки),
+// а склад на Rust выводит ячейки в порядке HashMap, поэтому перед сравнением
+// вывод сводится к записям вида "ADD ok", "REMOVE fail", "ZONE a 1.23", "WIN 1 15 10 5".
+// Строки, не относящиеся к результатам команд (заставка, справка), не сравниваются.
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <malloc.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+// параметры запуска
+struct Options {
+    string scenario;             // add, remove, info, mixed, enqueue или all
+    long lines = -1;             // строк в сценарии (-1 - по умолчанию для сценария)
+    unsigned seed = 1;           // начальное значение генератора
+    int windows = 5;             // окон приема для сценария очереди
+    string warehouseCpp = "./lr5-1";
+    string warehouseRust = "./lr5-1r";
+    string queueCpp = "./lr5-2";
+    string queueRust = "./lr5-2r";
+    bool keep = false;           // не удалять сценарии и выводы
+};
+
+// результат одного запуска
+struct RunResult {
+    bool ok = false;
+    double seconds = 0;
+    long peakRssKb = 0;
+    string outputFile;
+};
+
+// ===== генерация сценариев =====
+
+// простой детерминированный генератор (одинаковый сценарий при одинаковом seed)
+struct Rng {
+    unsigned long long state;
+    explicit Rng(unsigned seed) : state(seed * 2654435761ull + 1) {}
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned)(state >> 33) % bound;
+    }
+};
+
+// случайный адрес ячейки в формате склада: <зона><стеллаж><секция><полка>
+string randomAddress(Rng& rng) {
+    string addr;
+    addr += (char)('A' + rng.next(2));
+    addr += to_string(1 + rng.next(19));
+    addr += to_string(1 + rng.next(4));
+    addr += to_string(1 + rng.next(8));
+    return addr;
+}
+
+// число ячеек склада: 2 зоны * 19 стеллажей * 4 секции * 8 полок
+const int CELL_COUNT = 2 * 19 * 4 * 8;
+
+long defaultLines(const string& scenario) {
+    // INFO выводит все 1216 ячеек, поэтому для него строк меньше
+    return scenario == "info" ? 1000 : 1000000;
+}
+
+// команды заполнения склада перед сценарием: для remove, чтобы списания
+// в основном были успешными, и для info, чтобы выводились занятые ячейки
+long preloadCommands(const string& scenario) {
+    return scenario == "remove" || scenario == "info" ? CELL_COUNT : 0;
+}
+
+bool writeScenario(const string& scenario, long lines, const Options& opt, const string& path) {
+    ofstream out(path);
+    Rng rng(opt.seed);
+
+    if (scenario == "enqueue") {
+        out << opt.windows << "\n";
+        for (long i = 0; i < lines; ++i) out << "ENQUEUE " << 1 + rng.next(60) << "\n";
+        out << "DISTRIBUTE\n";
+        return (bool)out;
+    }
+
+    if (preloadCommands(scenario) > 0) {
+        for (int z = 0; z < 2; ++z)
+            for (int s = 1; s <= 19; ++s)
+                for (int sec = 1; sec <= 4; ++sec)
+                    for (int p = 1; p <= 8; ++p)
+                        out << "ADD item" << (s + sec + p) % 5 << " 10 " << (char)('A' + z)
+                            << s << sec << p << "\n";
+    }
+
+    for (long i = 0; i < lines; ++i) {
+        string cmd;
+        if (scenario == "add") cmd = "ADD";
+        else if (scenario == "remove") cmd = "REMOVE";
+        else if (scenario == "info") cmd = "INFO";
+        else cmd = rng.next(1000) == 0 ? "INFO" : (rng.next(2) ? "ADD" : "REMOVE");
+
+        if (cmd == "INFO") out << "INFO\n";
+        else out << cmd << " item" << rng.next(5) << " " << 1 + rng.next(3) << " " << randomAddress(rng) << "\n";
+    }
+    out << "EXIT\n";
+    return (bool)out;
+}
+
+// ===== запуск программы =====
+
+RunResult runProgram(const string& binary, const string& inputFile, const string& outputFile) {
+    RunResult result;
+    result.outputFile = outputFile;
+
+    int in = open(inputFile.c_str(), O_RDONLY);
+    int out = open(outputFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (in == -1 || out == -1) {
+        cerr << "ошибка: не удалось открыть файлы сценария: " << strerror(errno) << endl;
+        return result;
+    }
+
+    // пиковая память потомка учитывает и копию родителя до exec, поэтому
+    // возвращаем системе память, освобожденную после сверки прошлого сценария
+    malloc_trim(0);
+
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(in, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        execl(binary.c_str(), binary.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    close(in);
+    close(out);
+    if (pid == -1) {
+        cerr << "ошибка: fork: " << strerror(errno) << endl;
+        return result;
+    }
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.peakRssKb = usage.ru_maxrss;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        cerr << "ошибка: " << binary << " завершилась с кодом "
+             << (WIFEXITED(status) ? WEXITSTATUS(status) : -1) << endl;
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
+
+// ===== нормализация вывода =====
+
+// перевод в нижний регистр ASCII и русских букв в UTF-8
+string toLowerUtf8(const string& s) {
+    string r = s;
+    for (size_t i = 0; i < r.size(); ++i) {
+        unsigned char c = r[i];
+        if (c < 0x80) {
+            r[i] = (char)tolower(c);
+        } else if (c == 0xD0 && i + 1 < r.size()) {
+            unsigned char d = r[i + 1];
+            if (d >= 0x90 && d <= 0x9F) r[i + 1] = (char)(d + 0x20);           // А-П
+            else if (d >= 0xA0 && d <= 0xAF) { r[i] = (char)0xD1; r[i + 1] = (char)(d - 0x20); } // Р-Я
+            else if (d == 0x81) { r[i] = (char)0xD1; r[i + 1] = (char)0x91; }    // Ё
+            ++i;
+        } else if (c >= 0xC0) {
+            ++i; // прочие двухбайтовые символы не меняем
+        }
+    }
+    return r;
+}
+
+// удаление приглашений ко вводу, пробелов по краям и завершающей точки;
+// hadPrompt - была ли в строке приглашение (до первого идут заставка и справка)
+string cleanLine(string line, bool& hadPrompt) {
+    line = toLowerUtf8(line);
+    static const string PROMPTS[] = {"> введите команду:", "введите команду:"};
+    hadPrompt = false;
+    for (const string& prompt : PROMPTS) {
+        size_t pos;
+        while ((pos = line.find(prompt)) != string::npos) {
+            line.erase(pos, prompt.size());
+            hadPrompt = true;
+        }
+    }
+    size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == string::npos) return "";
+    size_t end = line.find_last_not_of(" \t\r");
+    line = line.substr(begin, end - begin + 1);
+    if (!line.empty() && line.back() == '.') line.pop_back();
+    return line;
+}
+
+bool startsWith(const string& s, const string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+vector<string> normalizeWarehouse(const string& file) {
+    ifstream in(file);
+    vector<string> records;
+    vector<string> cells; // ячейки с товаром текущего INFO (сортируются)
+    string raw;
+    bool started = false; // заставка и справка до первого приглашения не сравниваются
+    while (getline(in, raw)) {
+        bool hadPrompt;
+        string line = cleanLine(raw, hadPrompt);
+        started = started || hadPrompt;
+        if (line.empty() || !started) continue;
+
+        if (startsWith(line, "товар добавлен")) records.push_back("ADD ok");
+        else if (startsWith(line, "недостаточно места")) records.push_back("ADD full");
+        else if (startsWith(line, "товар удален")) records.push_back("REMOVE ok");
+        else if (startsWith(line, "недостаточно товара") || startsWith(line, "ячейка не найдена"))
+            records.push_back("REMOVE fail");
+        else if (startsWith(line, "неверн") || startsWith(line, "некорректн")) records.push_back("BAD");
+        else if (startsWith(line, "общий процент заполнения склада: "))
+            records.push_back("TOTAL " + line.substr(line.find(": ") + 2));
+        else if (startsWith(line, "зона ")) records.push_back("ZONE " + line.substr(strlen("зона ")));
+        else if (startsWith(line, "ячейки с товаром")) cells.clear();
+        else if (startsWith(line, "адрес: ")) cells.push_back("CELL " + line.substr(strlen("адрес: ")));
+        else if (startsWith(line, "пустые ячейки: ")) {
+            sort(cells.begin(), cells.end());
+            records.insert(records.end(), cells.begin(), cells.end());
+            cells.clear();
+            records.push_back("EMPTY " + line.substr(line.find(": ") + 2));
+        }
+        else records.push_back("OTHER " + line); // новое или измененное сообщение тоже сверяется
+    }
+    return records;
+}
+
+// все числа вида "(<число> мин" в строке, по порядку
+vector<string> durations(const string& line) {
+    vector<string> result;
+    size_t pos = 0;
+    while ((pos = line.find('(', pos)) != string::npos) {
+        size_t end = ++pos;
+        while (end < line.size() && isdigit((unsigned char)line[end])) ++end;
+        if (end > pos && line.compare(end, strlen(" мин"), " мин") == 0) {
+            result.push_back(line.substr(pos, end - pos));
+        }
+    }
+    return result;
+}
+
+// регулярные выражения здесь не используются: строка окна при 10^6 посетителей
+// слишком длинная для рекурсивного std::regex
+vector<string> normalizeQueue(const string& file) {
+    ifstream in(file);
+    vector<string> records;
+    string raw;
+    bool started = false; // заставка и справка до первого приглашения не сравниваются
+    while (getline(in, raw)) {
+        bool hadPrompt;
+        string line = cleanLine(raw, hadPrompt);
+        started = started || hadPrompt;
+        if (line.empty() || !started) continue;
+
+        if (startsWith(line, "> добавлен")) {
+            vector<string> d = durations(line);
+            records.push_back("ENQ " + (d.empty() ? string("?") : d[0]));
+        } else if (startsWith(line, "окно ")) {
+            // "окно 1 (общее время: 15 мин): T1 (10 мин), ..." или "окно 1 (15 мин): ..."
+            // талоны случайные - сравниваем только продолжительности
+            size_t numEnd = line.find(' ', strlen("окно "));
+            string record = "WIN " + line.substr(strlen("окно "), numEnd - strlen("окно "));
+            size_t colon = line.find("):");
+            string total = line.substr(0, colon + 1);
+            size_t digits = total.find_last_of("0123456789");
+            size_t start = total.find_last_not_of("0123456789", digits) + 1;
+            record += " " + total.substr(start, digits - start + 1);
+            if (colon != string::npos) {
+                for (const string& d : durations(line.substr(colon + 2))) record += " " + d;
+            }
+            records.push_back(record);
+        } else if (line.find("очередь пуста") != string::npos) {
+            records.push_back("EMPTY");
+        } else if (startsWith(line, "!")) {
+            records.push_back("BAD");
+        } else if (startsWith(line, "===")) {
+            // заголовок и нижняя рамка результатов распределения: у реализаций
+            // разный текст, сверяем только их наличие и место
+            records.push_back("RULE");
+        } else {
+            records.push_back("OTHER " + line); // новое или измененное сообщение тоже сверяется
+        }
+    }
+    return records;
+}
+
+// ===== сравнение и отчет =====
+
+// возвращает false при расхождении результатов
+bool runScenario(const string& scenario, const Options& opt, const string& dir) {
+    bool isQueue = scenario == "enqueue";
+    long lines = opt.lines > 0 ? opt.lines : defaultLines(scenario);
+    string input = dir + "/" + scenario + ".txt";
+    if (!writeScenario(scenario, lines, opt, input)) {
+        cerr << "ошибка: не удалось записать сценарий " << input << endl;
+        return false;
+    }
+
+    string cppBin = isQueue ? opt.queueCpp : opt.warehouseCpp;
+    string rustBin = isQueue ? opt.queueRust : opt.warehouseRust;
+    RunResult cpp = runProgram(cppBin, input, dir + "/" + scenario + ".cpp.out");
+    RunResult rust = runProgram(rustBin, input, dir + "/" + scenario + ".rust.out");
+
+    // пропускная способность считается по всем командам, включая заполнение склада
+    long preload = preloadCommands(scenario);
+    long commands = lines + preload;
+    cout << "\n=== сценарий " << scenario << ": " << lines << " команд";
+    if (preload > 0) cout << " + " << preload << " на заполнение склада";
+    cout << " ===\n";
+    // заголовок задан строкой: setw считает байты, а не русские буквы
+    cout << "реализация                  время, с пик RSS, МБ      команд/с\n";
+    for (const auto& [name, r] : {pair<string, RunResult&>{"C++  " + cppBin, cpp},
+                                  pair<string, RunResult&>{"Rust " + rustBin, rust}}) {
+        cout << left << setw(24) << name << right;
+        if (!r.ok) {
+            cout << "  не удалось выполнить\n";
+            continue;
+        }
+        cout << fixed << setprecision(3) << setw(12) << r.seconds
+             << setprecision(1) << setw(12) << r.peakRssKb / 1024.0
+             << setprecision(0) << setw(14) << commands / r.seconds << "\n";
+    }
+    if (!cpp.ok || !rust.ok) return false;
+
+    // сверка ответов
+    vector<string> a = isQueue ? normalizeQueue(cpp.outputFile) : normalizeWarehouse(cpp.outputFile);
+    vector<string> b = isQueue ? normalizeQueue(rust.outputFile) : normalizeWarehouse(rust.outputFile);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < max(a.size(), b.size()); ++i) {
+        const string& x = i < a.size() ? a[i] : "<нет>";
+        const string& y = i < b.size() ? b[i] : "<нет>";
+        if (x == y) continue;
+        if (++mismatches <= 5) {
+            cout << "расхождение в записи " << i + 1 << ":\n  C++:  " << x.substr(0, 200)
+                 << "\n  Rust: " << y.substr(0, 200) << "\n";
+        }
+    }
+    if (mismatches == 0) {
+        cout << "результаты совпадают (" << a.size() << " записей)\n";
+    } else {
+        cout << "РЕЗУЛЬТАТЫ РАЗЛИЧАЮТСЯ: " << mismatches << " записей"
+             << " (C++: " << a.size() << ", Rust: " << b.size() << ")\n";
+    }
+    return mismatches == 0;
+}
+
+void printUsage(const char* prog) {
+    cout << "использование: " << prog << " <сценарий> [параметры]\n"
+         << "сценарии склада (lr5-1 / lr5-1r): add, remove, info, mixed\n"
+         << "сценарий очереди (lr5-2 / lr5-2r): enqueue\n"
+         << "all - все сценарии по очереди\n"
+         << "параметры:\n"
+         << "  --lines N         команд в сценарии (по умолчанию 1000000, для info 1000)\n"
+         << "  --seed N          начальное значение генератора (1)\n"
+         << "  --windows N       окон приема для enqueue (5)\n"
+         << "  --warehouse-cpp P, --warehouse-rust P, --queue-cpp P, --queue-rust P\n"
+         << "                    пути к программам (./lr5-1, ./lr5-1r, ./lr5-2, ./lr5-2r)\n"
+         << "  --keep            не удалять сценарии и выводы программ\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    opt.scenario = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        string key = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (key == "--keep") opt.keep = true;
+        else if (key == "--lines" && hasValue) opt.lines = atol(argv[++i]);
+        else if (key == "--seed" && hasValue) opt.seed = (unsigned)atol(argv[++i]);
+        else if (key == "--windows" && hasValue) opt.windows = atoi(argv[++i]);
+        else if (key == "--warehouse-cpp" && hasValue) opt.warehouseCpp = argv[++i];
+        else if (key == "--warehouse-rust" && hasValue) opt.warehouseRust = argv[++i];
+        else if (key == "--queue-cpp" && hasValue) opt.queueCpp = argv[++i];
+        else if (key == "--queue-rust" && hasValue) opt.queueRust = argv[++i];
+        else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    vector<string> scenarios;
+    if (opt.scenario == "all") scenarios = {"add", "remove", "info", "mixed", "enqueue"};
+    else if (opt.scenario == "add" || opt.scenario == "remove" || opt.scenario == "info"
+             || opt.scenario == "mixed" || opt.scenario == "enqueue") scenarios = {opt.scenario};
+    else {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (opt.windows <= 0) {
+        cerr << "ошибка: число окон должно быть больше 0" << endl;
+        return 2;
+    }
+
+    char dirTemplate[] = "/tmp/lr5-bench-XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        cerr << "ошибка: не удалось создать временный каталог: " << strerror(errno) << endl;
+        return 2;
+    }
+    string dir = dirTemplate;
+
+    bool allMatch = true;
+    for (const string& scenario : scenarios) {
+        if (!runScenario(scenario, opt, dir)) allMatch = false;
+    }
+
+    if (opt.keep) {
+        cout << "\nсценарии и выводы сохранены в " << dir << "\n";
+    } else {
+        error_code ec;
+        filesystem::remove_all(dir, ec);
+        if (ec) cerr << "не удалось удалить " << dir << ": " << ec.message() << endl;
+    }
+    return allMatch ? 0 : 1;
+}